@@ -1,24 +1,95 @@
 #pragma once
 
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+
 #include <deggua/types.h>
+#include <deggua/units.h>
+#include <deggua/bitops.h>
+
+// Define MEMORY_ARENA_STATS to have every arena track how it's used (compiled out entirely otherwise)
+#ifdef MEMORY_ARENA_STATS
+# define MEMORY_ARENA_STATS_MAX_DEPTH (32)
+
+typedef struct {
+    const char* file;
+    int         line;
+    char*       parent_high; // parent scope's high water mark when the scope began
+} MemoryArenaSite;
 
 typedef struct {
-    char* base;     // base of arena allocation
-    char* head;     // next free position
-    usize virt_size; // virtual space reserved
-    usize phys_size; // physical space committed
+    usize peak_used;        // high water mark of head - base
+    usize alloc_count;      // number of allocations
+    usize alloc_bytes;      // bytes requested by allocations
+    usize align_waste;      // bytes skipped to satisfy alignment
+    usize commit_count;     // number of times physical memory was committed
+    usize decommit_count;   // number of times physical memory was released
+    usize restore_count;    // number of scope rollbacks
+    usize restore_bytes;    // bytes rolled back by scopes
+    usize leaked_scopes;    // scopes that were never restored (e.g. `return` out of MemoryArena_Scope)
+    usize scope_depth;      // currently open scopes
+    char* scope_high;       // high water mark of head inside the innermost open scope
+    usize largest_scope;    // most bytes any single scope used
+    MemoryArenaSite largest_scope_site;
+    MemoryArenaSite last_leak_site;
+    MemoryArenaSite open_sites[MEMORY_ARENA_STATS_MAX_DEPTH];
+} MemoryArenaStats;
+#endif
+
+typedef struct {
+    char* base;        // base of arena allocation
+    char* head;        // next free position
+    usize virt_size;   // virtual space reserved
+    usize phys_size;   // physical space committed
+    usize commit_size; // granularity physical memory is committed/released in
+    u32   flags;       // MEMORY_ARENA_FLAG_*
+    u64   epoch;       // bumped whenever allocations are invalidated (reset/release/restore)
+#ifdef MEMORY_ARENA_STATS
+    MemoryArenaStats stats;
+#endif
 } MemoryArena;
 
 typedef struct {
     char* head;
+#ifdef MEMORY_ARENA_STATS
+    char* parent_high;  // parent scope's high water mark when the scope began
+    usize depth;        // depth of this scope (1 = outermost)
+    usize alloc_count;  // arena allocation count when the scope began, the scope's count after restoring
+    usize scope_peak;   // bytes used by the scope at its peak (valid after restoring)
+#endif
 } MemoryArenaCheckpoint;
 
+// per-thread block cache for allocating from an arena shared between threads
+typedef struct {
+    MemoryArena* arena;
+    char*        head;       // next free position in the cached block
+    char*        end;        // end of the cached block
+    usize        block_size; // size of the blocks carved from the arena
+    u64          epoch;      // arena epoch the cached block belongs to
+} MemoryArenaCache;
+
+#define MEMORY_ARENA_FLAG_HUGE_PAGES (1u << 0) // back the arena with transparent huge pages (MADV_HUGEPAGE)
+#define MEMORY_ARENA_FLAG_HUGETLB    (1u << 1) // back the arena with explicit huge pages (MAP_HUGETLB), the full size is reserved from the hugetlb pool up front, falls back to transparent huge pages
+#define MEMORY_ARENA_FLAG_LAZY_FREE  (1u << 2) // release memory with MADV_FREE instead of MADV_DONTNEED (RSS drops under memory pressure)
+
+#define MEMORY_ARENA_DEFAULT_COMMIT_SIZE (64 * KiB)
+#define MEMORY_ARENA_HUGE_PAGE_SIZE      (2 * MiB)
+#define MEMORY_ARENA_CACHE_BLOCK_SIZE    (16 * KiB)
+
+#ifdef MEMORY_ARENA_STATS
+# define MemoryArena__ScopeCheckpoint(_arena) MemoryArena_CheckpointAt((_arena), __FILE__, __LINE__)
+#else
+# define MemoryArena__ScopeCheckpoint(_arena) MemoryArena_Checkpoint((_arena))
+#endif
+
 // WARNING: breaking control flow (return, break, goto) will not work correctly with this macro
-#define MemoryArena_Scope(_arena) for (MemoryArenaCheckpoint state = MemoryArena_Checkpoint((_arena)), loop_terminator_ = {(void*)~(uintptr_t)NULL}; loop_terminator_.head; MemoryArena_Restore((_arena), &state), loop_terminator_.head = NULL)
+#define MemoryArena_Scope(_arena) for (MemoryArenaCheckpoint state = MemoryArena__ScopeCheckpoint((_arena)), loop_terminator_ = {.head = (void*)~(uintptr_t)NULL}; loop_terminator_.head; MemoryArena_Restore((_arena), &state), loop_terminator_.head = NULL)
 
 /* --- Arena Management --- */
 
 bool MemoryArena_New(MemoryArena* arena, usize max_size); // Initializes a virtually mapped memory arena of `max_size` bytes (rounded up to the page size)
+bool MemoryArena_New_Policy(MemoryArena* arena, usize max_size, usize commit_size, u32 flags); // Same as above, committing `commit_size` bytes at a time (0 => default) with MEMORY_ARENA_FLAG_* behavior
 void MemoryArena_Delete(MemoryArena* arena);                  // Destroys a memory arena, releasing all the memory back to the OS
 void MemoryArena_Reset(MemoryArena* arena);                   // Resets the arena, does not release the memory to the OS (very cheap)
 bool MemoryArena_Release(MemoryArena* arena);                 // Resets the arena and releases the physical memory back to the OS
@@ -40,3 +111,508 @@ void* MemoryArena_ZPackedAlloc(MemoryArena* arena, usize size);
 
 MemoryArenaCheckpoint MemoryArena_Checkpoint(MemoryArena* arena);                   // Begin a local scope in an arena (begin temporary free-able sub-arena)
 void MemoryArena_Restore(MemoryArena* arena, MemoryArenaCheckpoint* restore_from); // End a local scope in an arena (free temporary sub-arena)
+
+/* --- Arena Statistics --- */
+
+void MemoryArena_Report(const MemoryArena* arena, FILE* out); // Print the arena's usage (and statistics if MEMORY_ARENA_STATS is defined)
+
+#ifdef MEMORY_ARENA_STATS
+MemoryArenaCheckpoint MemoryArena_CheckpointAt(MemoryArena* arena, const char* file, int line); // MemoryArena_Checkpoint, attributing the scope to `file`:`line` in reports
+#endif
+
+/* --- Concurrent Arena Allocation --- */
+// Safe to call from many threads at once on the same arena, everything else (reset, shrink, scopes, the
+// non-atomic allocators) must only run while no thread is allocating. Allocations may waste up to
+// `alignment_pow2 - 1` bytes, use a MemoryArenaCache per thread for small allocations.
+
+void* MemoryArena_AtomicUAlignedAlloc(MemoryArena* arena, usize alignment_pow2, usize size); // Allocate aligned memory from a shared arena (uninitialized)
+void* MemoryArena_AtomicUAlloc(MemoryArena* arena, usize size);                               // Allocate memory with default platform alignment from a shared arena (uninitialized)
+void* MemoryArena_AtomicZAlignedAlloc(MemoryArena* arena, usize alignment_pow2, usize size); // Allocate aligned memory from a shared arena (zero filled)
+void* MemoryArena_AtomicZAlloc(MemoryArena* arena, usize size);                               // Allocate memory with default platform alignment from a shared arena (zero filled)
+
+/* --- Per-Thread Arena Caches --- */
+// Each thread owns its cache (e.g. `_Thread_local`), blocks are carved from the shared arena with the atomic
+// allocator and then bump allocated without contention. Resetting the arena invalidates every cache.
+
+void  MemoryArenaCache_New(MemoryArenaCache* cache, MemoryArena* arena, usize block_size);            // Initializes a cache over a shared arena (0 => MEMORY_ARENA_CACHE_BLOCK_SIZE)
+void* MemoryArenaCache_UAlignedAlloc(MemoryArenaCache* cache, usize alignment_pow2, usize size); // Allocate aligned memory through the cache (uninitialized)
+void* MemoryArenaCache_UAlloc(MemoryArenaCache* cache, usize size);                               // Allocate memory with default platform alignment through the cache (uninitialized)
+void* MemoryArenaCache_ZAlignedAlloc(MemoryArenaCache* cache, usize alignment_pow2, usize size); // Allocate aligned memory through the cache (zero filled)
+void* MemoryArenaCache_ZAlloc(MemoryArenaCache* cache, usize size);                               // Allocate memory with default platform alignment through the cache (zero filled)
+
+/* --- Implementation --- */
+
+#define MEMORY_ARENA_DEFAULT_ALIGNMENT (_Alignof(max_align_t))
+
+// invalidates the per-thread caches, the non-atomic API has the arena to itself so this doesn't need a locked RMW
+static inline void MemoryArena__BumpEpoch(MemoryArena* arena)
+{
+    u64 epoch = __atomic_load_n(&arena->epoch, __ATOMIC_RELAXED);
+    __atomic_store_n(&arena->epoch, epoch + 1, __ATOMIC_RELEASE);
+}
+
+// bookkeeping for an allocation of [ptr, end) that started searching at `start`
+static inline void MemoryArena__StatAlloc(MemoryArena* arena, char* start, char* ptr, char* end)
+{
+#ifdef MEMORY_ARENA_STATS
+    MemoryArenaStats* stats = &arena->stats;
+
+    stats->alloc_count += 1;
+    stats->alloc_bytes += end - ptr;
+    stats->align_waste += ptr - start;
+    stats->peak_used    = max(stats->peak_used, (usize)(end - arena->base));
+    stats->scope_high   = max(stats->scope_high, end);
+#else
+    UNUSED(arena), UNUSED(start), UNUSED(ptr), UNUSED(end);
+#endif
+}
+
+// same as above for allocations that may race with other threads
+static inline void MemoryArena__StatAtomicAlloc(MemoryArena* arena, char* start, char* ptr, char* end, usize reserve)
+{
+#ifdef MEMORY_ARENA_STATS
+    MemoryArenaStats* stats = &arena->stats;
+
+    __atomic_fetch_add(&stats->alloc_count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats->alloc_bytes, end - ptr, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats->align_waste, reserve - (end - ptr), __ATOMIC_RELAXED);
+
+    usize used = start + reserve - arena->base;
+    usize peak = __atomic_load_n(&stats->peak_used, __ATOMIC_RELAXED);
+    while (peak < used && !__atomic_compare_exchange_n(&stats->peak_used, &peak, used, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+#else
+    UNUSED(arena), UNUSED(start), UNUSED(ptr), UNUSED(end), UNUSED(reserve);
+#endif
+}
+
+#ifdef MEMORY_ARENA_STATS
+# define MemoryArena__StatCount(_arena, _counter) __atomic_fetch_add(&(_arena)->stats._counter, 1, __ATOMIC_RELAXED)
+#else
+# define MemoryArena__StatCount(_arena, _counter) ((void)0)
+#endif
+
+// commits physical memory so that [base, end) is accessible
+SYM_WEAK
+bool MemoryArena__Commit(MemoryArena* arena, char* end)
+{
+    usize need = end - arena->base;
+    if (need <= arena->phys_size) return true;
+    if (need > arena->virt_size) return false;
+
+    usize new_phys = min(alignp2_64(need, arena->commit_size), arena->virt_size);
+    if (mprotect(arena->base + arena->phys_size, new_phys - arena->phys_size, PROT_READ | PROT_WRITE)) {
+        return false;
+    }
+
+    MemoryArena__StatCount(arena, commit_count);
+
+    arena->phys_size = new_phys;
+    return true;
+}
+
+// releases the physical memory backing [base + keep, base + phys_size)
+SYM_WEAK
+bool MemoryArena__Decommit(MemoryArena* arena, usize keep)
+{
+    keep = alignp2_64(keep, arena->commit_size);
+    if (keep >= arena->phys_size) return true;
+
+    char* start = arena->base + keep;
+    usize len   = arena->phys_size - keep;
+
+    // MADV_FREE isn't supported for hugetlb mappings, MADV_DONTNEED is
+    int advice = MADV_DONTNEED;
+#ifdef MADV_FREE
+    if ((arena->flags & (MEMORY_ARENA_FLAG_LAZY_FREE | MEMORY_ARENA_FLAG_HUGETLB)) == MEMORY_ARENA_FLAG_LAZY_FREE) {
+        advice = MADV_FREE;
+    }
+#endif
+
+    if (madvise(start, len, advice)) return false;
+    if (mprotect(start, len, PROT_NONE)) return false;
+
+    MemoryArena__StatCount(arena, decommit_count);
+
+    arena->phys_size = keep;
+    return true;
+}
+
+SYM_WEAK
+bool MemoryArena_New_Policy(MemoryArena* arena, usize max_size, usize commit_size, u32 flags)
+{
+    usize page_size = sysconf(_SC_PAGESIZE);
+    bool  huge      = flags & (MEMORY_ARENA_FLAG_HUGE_PAGES | MEMORY_ARENA_FLAG_HUGETLB);
+
+    // commits are done in page (or huge page) multiples
+    usize granule = huge ? MEMORY_ARENA_HUGE_PAGE_SIZE : page_size;
+    commit_size   = alignp2_64(commit_size ? commit_size : MEMORY_ARENA_DEFAULT_COMMIT_SIZE, granule);
+    max_size      = alignp2_64(max(max_size, granule), granule);
+
+    char* base = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+    if (flags & MEMORY_ARENA_FLAG_HUGETLB) {
+        base = mmap(NULL, max_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+#endif
+
+    if (base == MAP_FAILED) {
+        flags &= ~MEMORY_ARENA_FLAG_HUGETLB;
+
+        // over-reserve so the base can be huge page aligned, otherwise THP can't back the first/last chunks
+        usize reserve = huge ? max_size + MEMORY_ARENA_HUGE_PAGE_SIZE : max_size;
+
+        char* reservation = mmap(NULL, reserve, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (reservation == MAP_FAILED) return false;
+
+        base = reservation;
+        if (huge) {
+            base = (char*)alignp2_64((uptr)reservation, MEMORY_ARENA_HUGE_PAGE_SIZE);
+
+            usize lead  = base - reservation;
+            usize trail = reserve - lead - max_size;
+            if (lead) munmap(reservation, lead);
+            if (trail) munmap(base + max_size, trail);
+
+#ifdef MADV_HUGEPAGE
+            // advice isn't fatal, the arena still works without THP
+            madvise(base, max_size, MADV_HUGEPAGE);
+            flags |= MEMORY_ARENA_FLAG_HUGE_PAGES;
+#endif
+        }
+    }
+
+    arena->base        = base;
+    arena->head        = base;
+    arena->virt_size   = max_size;
+    arena->phys_size   = 0;
+    arena->commit_size = commit_size;
+    arena->flags       = flags;
+    arena->epoch       = 0;
+
+#ifdef MEMORY_ARENA_STATS
+    memset(&arena->stats, 0x00, sizeof(arena->stats));
+    arena->stats.scope_high = base;
+#endif
+
+    return true;
+}
+
+SYM_WEAK
+bool MemoryArena_New(MemoryArena* arena, usize max_size)
+{
+    return MemoryArena_New_Policy(arena, max_size, 0, 0);
+}
+
+SYM_WEAK
+void MemoryArena_Delete(MemoryArena* arena)
+{
+    munmap(arena->base, arena->virt_size);
+
+    arena->base      = NULL;
+    arena->head      = NULL;
+    arena->virt_size = 0;
+    arena->phys_size = 0;
+}
+
+SYM_WEAK
+void MemoryArena_Reset(MemoryArena* arena)
+{
+    arena->head = arena->base;
+    MemoryArena__BumpEpoch(arena);
+
+#ifdef MEMORY_ARENA_STATS
+    arena->stats.scope_depth = 0;
+    arena->stats.scope_high  = arena->base;
+#endif
+}
+
+SYM_WEAK
+bool MemoryArena_Release(MemoryArena* arena)
+{
+    MemoryArena_Reset(arena);
+    return MemoryArena__Decommit(arena, 0);
+}
+
+SYM_WEAK
+bool MemoryArena_Shrink(MemoryArena* arena)
+{
+    return MemoryArena__Decommit(arena, arena->head - arena->base);
+}
+
+SYM_WEAK
+void* MemoryArena_UAlignedAlloc(MemoryArena* arena, usize alignment_pow2, usize size)
+{
+    char* ptr = (char*)alignp2_64((uptr)arena->head, alignment_pow2);
+    char* end = ptr + size;
+
+    if (unlikely(end > arena->base + arena->phys_size)) {
+        if (ptr < arena->head || end < ptr) return NULL; // overflow
+        if (!MemoryArena__Commit(arena, end)) return NULL;
+    }
+
+    MemoryArena__StatAlloc(arena, arena->head, ptr, end);
+
+    arena->head = end;
+    return ptr;
+}
+
+SYM_WEAK
+void* MemoryArena_UAlloc(MemoryArena* arena, usize size)
+{
+    return MemoryArena_UAlignedAlloc(arena, MEMORY_ARENA_DEFAULT_ALIGNMENT, size);
+}
+
+SYM_WEAK
+void* MemoryArena_UPackedAlloc(MemoryArena* arena, usize size)
+{
+    return MemoryArena_UAlignedAlloc(arena, 1, size);
+}
+
+SYM_WEAK
+void* MemoryArena_ZAlignedAlloc(MemoryArena* arena, usize alignment_pow2, usize size)
+{
+    void* ptr = MemoryArena_UAlignedAlloc(arena, alignment_pow2, size);
+    if (ptr) memset(ptr, 0x00, size);
+
+    return ptr;
+}
+
+SYM_WEAK
+void* MemoryArena_ZAlloc(MemoryArena* arena, usize size)
+{
+    return MemoryArena_ZAlignedAlloc(arena, MEMORY_ARENA_DEFAULT_ALIGNMENT, size);
+}
+
+SYM_WEAK
+void* MemoryArena_ZPackedAlloc(MemoryArena* arena, usize size)
+{
+    return MemoryArena_ZAlignedAlloc(arena, 1, size);
+}
+
+#ifdef MEMORY_ARENA_STATS
+SYM_WEAK
+MemoryArenaCheckpoint MemoryArena_CheckpointAt(MemoryArena* arena, const char* file, int line)
+{
+    MemoryArenaStats* stats = &arena->stats;
+
+    MemoryArenaCheckpoint checkpoint = {
+        .head        = arena->head,
+        .parent_high = stats->scope_high,
+        .depth       = ++stats->scope_depth,
+        .alloc_count = stats->alloc_count,
+    };
+
+    if (checkpoint.depth <= MEMORY_ARENA_STATS_MAX_DEPTH) {
+        stats->open_sites[checkpoint.depth - 1] = (MemoryArenaSite){file, line, stats->scope_high};
+    }
+
+    stats->scope_high = arena->head;
+    return checkpoint;
+}
+#endif
+
+SYM_WEAK
+MemoryArenaCheckpoint MemoryArena_Checkpoint(MemoryArena* arena)
+{
+#ifdef MEMORY_ARENA_STATS
+    return MemoryArena_CheckpointAt(arena, "?", 0);
+#else
+    return (MemoryArenaCheckpoint){.head = arena->head};
+#endif
+}
+
+SYM_WEAK
+void MemoryArena_Restore(MemoryArena* arena, MemoryArenaCheckpoint* restore_from)
+{
+#ifdef MEMORY_ARENA_STATS
+    MemoryArenaStats* stats = &arena->stats;
+
+    // nested scopes that were skipped over never restored, their allocations leaked into this scope
+    if (stats->scope_depth > restore_from->depth) {
+        stats->leaked_scopes += stats->scope_depth - restore_from->depth;
+        if (stats->scope_depth <= MEMORY_ARENA_STATS_MAX_DEPTH) {
+            stats->last_leak_site = stats->open_sites[stats->scope_depth - 1];
+        }
+
+        // fold the leaked scopes' high water marks back into this one
+        for (usize depth = min(stats->scope_depth, MEMORY_ARENA_STATS_MAX_DEPTH); depth > restore_from->depth; depth--) {
+            stats->scope_high = max(stats->scope_high, stats->open_sites[depth - 1].parent_high);
+        }
+    }
+
+    restore_from->scope_peak  = stats->scope_high - restore_from->head;
+    restore_from->alloc_count = stats->alloc_count - restore_from->alloc_count;
+
+    if (restore_from->scope_peak > stats->largest_scope && restore_from->depth <= MEMORY_ARENA_STATS_MAX_DEPTH) {
+        stats->largest_scope      = restore_from->scope_peak;
+        stats->largest_scope_site = stats->open_sites[restore_from->depth - 1];
+    }
+
+    stats->restore_count += 1;
+    stats->restore_bytes += arena->head - restore_from->head;
+    stats->scope_depth    = restore_from->depth - 1;
+    stats->scope_high     = max(restore_from->parent_high, stats->scope_high);
+#endif
+
+    arena->head = restore_from->head;
+    MemoryArena__BumpEpoch(arena);
+}
+
+SYM_WEAK
+void MemoryArena_Report(const MemoryArena* arena, FILE* out)
+{
+    fprintf(out, "MemoryArena %p\n", (void*)arena->base);
+    fprintf(out, "  reserved:        %zu bytes\n", arena->virt_size);
+    fprintf(out, "  committed:       %zu bytes\n", arena->phys_size);
+    fprintf(out, "  used:            %zu bytes\n", (usize)(arena->head - arena->base));
+
+#ifdef MEMORY_ARENA_STATS
+    const MemoryArenaStats* stats = &arena->stats;
+
+    fprintf(out, "  peak used:       %zu bytes (%.1f%% of reserved)\n", stats->peak_used, 100.0 * stats->peak_used / arena->virt_size);
+    fprintf(out, "  allocations:     %zu (%zu bytes)\n", stats->alloc_count, stats->alloc_bytes);
+    fprintf(out, "  alignment waste: %zu bytes\n", stats->align_waste);
+    fprintf(out, "  commits:         %zu\n", stats->commit_count);
+    fprintf(out, "  decommits:       %zu\n", stats->decommit_count);
+    fprintf(out, "  restores:        %zu (%zu bytes)\n", stats->restore_count, stats->restore_bytes);
+    fprintf(out, "  open scopes:     %zu\n", stats->scope_depth);
+
+    if (stats->largest_scope) {
+        fprintf(out, "  largest scope:   %zu bytes @ %s:%d\n", stats->largest_scope, stats->largest_scope_site.file, stats->largest_scope_site.line);
+    }
+
+    if (stats->leaked_scopes) {
+        fprintf(out, "  leaked scopes:   %zu, last @ %s:%d\n", stats->leaked_scopes, stats->last_leak_site.file, stats->last_leak_site.line);
+    }
+#endif
+}
+
+// lock-free version of MemoryArena__Commit, racing threads may mprotect overlapping ranges which is harmless
+SYM_WEAK
+bool MemoryArena__AtomicCommit(MemoryArena* arena, char* end)
+{
+    usize need = end - arena->base;
+    if (need > arena->virt_size) return false;
+
+    usize phys = __atomic_load_n(&arena->phys_size, __ATOMIC_ACQUIRE);
+    while (need > phys) {
+        usize new_phys = min(alignp2_64(need, arena->commit_size), arena->virt_size);
+        if (mprotect(arena->base + phys, new_phys - phys, PROT_READ | PROT_WRITE)) {
+            return false;
+        }
+
+        MemoryArena__StatCount(arena, commit_count);
+
+        // on failure `phys` is reloaded and we only loop if the winner committed less than we need
+        if (__atomic_compare_exchange_n(&arena->phys_size, &phys, new_phys, false, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+    }
+
+    return true;
+}
+
+SYM_WEAK
+void* MemoryArena_AtomicUAlignedAlloc(MemoryArena* arena, usize alignment_pow2, usize size)
+{
+    usize reserve = size + alignment_pow2 - 1;
+    if (unlikely(reserve < size || reserve > arena->virt_size)) return NULL;
+
+    char* start = __atomic_fetch_add(&arena->head, reserve, __ATOMIC_RELAXED);
+    char* ptr   = (char*)alignp2_64((uptr)start, alignment_pow2);
+    char* end   = ptr + size;
+
+    if (unlikely(end > arena->base + __atomic_load_n(&arena->phys_size, __ATOMIC_ACQUIRE))) {
+        // the arena is exhausted, head stays past the end so every later allocation fails too
+        if (!MemoryArena__AtomicCommit(arena, end)) return NULL;
+    }
+
+    MemoryArena__StatAtomicAlloc(arena, start, ptr, end, reserve);
+
+    return ptr;
+}
+
+SYM_WEAK
+void* MemoryArena_AtomicUAlloc(MemoryArena* arena, usize size)
+{
+    return MemoryArena_AtomicUAlignedAlloc(arena, MEMORY_ARENA_DEFAULT_ALIGNMENT, size);
+}
+
+SYM_WEAK
+void* MemoryArena_AtomicZAlignedAlloc(MemoryArena* arena, usize alignment_pow2, usize size)
+{
+    void* ptr = MemoryArena_AtomicUAlignedAlloc(arena, alignment_pow2, size);
+    if (ptr) memset(ptr, 0x00, size);
+
+    return ptr;
+}
+
+SYM_WEAK
+void* MemoryArena_AtomicZAlloc(MemoryArena* arena, usize size)
+{
+    return MemoryArena_AtomicZAlignedAlloc(arena, MEMORY_ARENA_DEFAULT_ALIGNMENT, size);
+}
+
+SYM_WEAK
+void MemoryArenaCache_New(MemoryArenaCache* cache, MemoryArena* arena, usize block_size)
+{
+    cache->arena      = arena;
+    cache->head       = NULL;
+    cache->end        = NULL;
+    cache->block_size = block_size ? block_size : MEMORY_ARENA_CACHE_BLOCK_SIZE;
+    cache->epoch      = __atomic_load_n(&arena->epoch, __ATOMIC_ACQUIRE);
+}
+
+SYM_WEAK
+void* MemoryArenaCache_UAlignedAlloc(MemoryArenaCache* cache, usize alignment_pow2, usize size)
+{
+    u64 epoch = __atomic_load_n(&cache->arena->epoch, __ATOMIC_ACQUIRE);
+    if (unlikely(cache->epoch != epoch)) {
+        // the arena was reset under us, the cached block no longer belongs to this cache
+        cache->head  = NULL;
+        cache->end   = NULL;
+        cache->epoch = epoch;
+    }
+
+    char* ptr = (char*)alignp2_64((uptr)cache->head, alignment_pow2);
+    if (likely(cache->head && ptr + size <= cache->end && ptr + size >= ptr)) {
+        cache->head = ptr + size;
+        return ptr;
+    }
+
+    // large allocations go straight to the arena so they don't throw away the rest of the block
+    if (size + alignment_pow2 > cache->block_size / 4) {
+        return MemoryArena_AtomicUAlignedAlloc(cache->arena, alignment_pow2, size);
+    }
+
+    char* block = MemoryArena_AtomicUAlignedAlloc(cache->arena, TARGET_CACHE_LINE_SIZE, cache->block_size);
+    if (!block) return NULL;
+
+    ptr         = (char*)alignp2_64((uptr)block, alignment_pow2);
+    cache->head = ptr + size;
+    cache->end  = block + cache->block_size;
+
+    return ptr;
+}
+
+SYM_WEAK
+void* MemoryArenaCache_UAlloc(MemoryArenaCache* cache, usize size)
+{
+    return MemoryArenaCache_UAlignedAlloc(cache, MEMORY_ARENA_DEFAULT_ALIGNMENT, size);
+}
+
+SYM_WEAK
+void* MemoryArenaCache_ZAlignedAlloc(MemoryArenaCache* cache, usize alignment_pow2, usize size)
+{
+    void* ptr = MemoryArenaCache_UAlignedAlloc(cache, alignment_pow2, size);
+    if (ptr) memset(ptr, 0x00, size);
+
+    return ptr;
+}
+
+SYM_WEAK
+void* MemoryArenaCache_ZAlloc(MemoryArenaCache* cache, usize size)
+{
+    return MemoryArenaCache_ZAlignedAlloc(cache, MEMORY_ARENA_DEFAULT_ALIGNMENT, size);
+}
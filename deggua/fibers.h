@@ -1,23 +1,1913 @@
 #pragma once
 
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <linux/io_uring.h>
+
 #include <deggua/types.h>
+#include <deggua/units.h>
+#include <deggua/bitops.h>
+#include <deggua/threads.h>
 
-typedef struct {
-    // registers
-    // stack
-    // etc.
+// Cooperative fibers with hand written context switching. Only the callee saved registers are swapped (no signal
+// mask, no FPU/SSE control words), so fibers must not change the rounding mode/MXCSR. Stacks are mmap'd with a
+// guard page below them and recycled through a global pool.
+//
+// Fibers either run on the scheduler's worker threads (FiberScheduler_Start) or, if it isn't running, on the
+// thread that started them whenever that thread calls Fiber_Join. Workers keep woken fibers in work stealing deques
+// (the owner pops the newest, idle workers steal the oldest from random victims before going to sleep) and fibers
+// that yielded in a FIFO only the owner touches, so a yield doesn't need a single atomic RMW or fence.
+//
+// Every worker has an epoll reactor, Fiber_WaitUntil parks the fiber with the fd armed one-shot in the reactor of
+// the worker it's running on. Workers harvest ready fds when they run out of fibers (and periodically while busy),
+// sleeping in epoll_wait when there's nothing left to do. A reader and a writer can wait on the same fd at once (the
+// fd is armed with both of their events), a second reader or writer of an fd on the same worker fails with EBUSY.
+//
+// Fiber_Read/Fiber_Write/Fiber_Accept go through a per-worker io_uring when the kernel allows it. Operations are
+// queued as fibers park and submitted together once the worker runs out of runnable fibers, completions are reaped
+// from the ring without a syscall (the ring fd sits in the reactor so idle workers wake up for them). Without
+// io_uring, or while the ring has no room for another operation (or its completion), they fall back to non-blocking
+// syscalls + Fiber_WaitUntil, so fds should be O_NONBLOCK.
+//
+// Timeouts live in a hierarchical timer wheel per worker (millisecond ticks, 6 levels of 64 slots), a timer is
+// only ever touched by the worker whose wheel holds it so insert and cancel are O(1) list operations. A timed
+// Fiber_JoinTimeout woken from another worker is handed to the owning worker's inbox to cancel its timer.
+
+#if TARGET_ARCH != TARGET_ARCH_AMD64 || TARGET_OS != TARGET_OS_LINUX
+# error "Fibers are only implemented for x86-64 Linux"
+#endif
+
+typedef struct FiberTimer {
+    struct FiberTimer*  prev;
+    struct FiberTimer*  next;
+    struct FiberWorker* owner;   // worker whose wheel holds the timer
+    u64                 expires; // CLOCK_MONOTONIC ms, UINT64_MAX for waits without a timeout
+    u8                  kind;    // FIBER__TIMER_*, NONE while not in a wheel
+    u8                  level;
+    u8                  slot;
+} FiberTimer;
+
+typedef struct Fiber {
+    void*         sp;          // saved stack pointer while switched out
+    u8*           stack;       // stack mapping (guard page at the bottom)
+    usize         stack_size;  // size of the stack mapping including the guard page
+    void*       (*entry_point)(void* arg);
+    void*         arg;
+    void*         result;      // entry point's return value once finished
+    struct Fiber* next;        // link in the scheduler's shared queue
+    struct Fiber* joiner;      // fiber blocked in Fiber_Join on this one (FIBER__JOINED once finished)
+    u32           state;       // FIBER_STATE_*
+    int           wait_fd;     // fd being waited on in Fiber_WaitUntil
+    u32           wait_events; // events being waited for
+    int           wait_result; // ready events, -1 on failure w/ `wait_errno`
+    int           wait_errno;
+    FiberTimer    timer;         // timeout of the current wait
+    struct Fiber* inbox_next;    // link in another worker's inbox
+    u32           inbox_pending; // set while queued in an inbox
 } Fiber;
 
-bool Fiber_New(Fiber* self, usize stack_size);
-bool Fiber_Delete(Fiber* self);
+#define FIBER_STATE_IDLE     (0) // created, not started (or finished and joined)
+#define FIBER_STATE_RUNNABLE (1) // started, waiting for a thread to run it
+#define FIBER_STATE_RUNNING  (2) // running on a thread
+#define FIBER_STATE_WAITING  (3) // blocked (join, I/O, sleep)
+#define FIBER_STATE_DONE     (4) // entry point returned
+
+#define FIBER_DEFAULT_STACK_SIZE (64 * KiB)
+#define FIBER_STACK_POOL_MAX     (256)  // stacks kept for reuse, the rest are unmapped
+#define FIBER_WORKER_QUEUE_SIZE  (4096) // runnable fibers per worker before they spill into the shared queue
+#define FIBER_REACTOR_BATCH      (64)   // events harvested per epoll_wait
+#define FIBER_RING_ENTRIES       (256)  // io_uring submission queue size per worker
+#define FIBER_TIMER_LEVELS       (6)    // 64 slots per level, later timeouts wait in an overflow list
 
-void  Fiber_Start(Fiber* self, void* (*entry_point)(void* arg));
-void* Fiber_Join(Fiber* self);
+bool Fiber_New(Fiber* self, usize stack_size); // 0 => FIBER_DEFAULT_STACK_SIZE, rounded up to the page size
+bool Fiber_Delete(Fiber* self);                // fails if the fiber is started and hasn't been joined
+
+void  Fiber_Start(Fiber* self, void* (*entry_point)(void* arg), void* arg);
+void* Fiber_Join(Fiber* self); // from a thread (not a fiber) this blocks, or runs fibers if there's no scheduler
+
+bool  Fiber_JoinTimeout(Fiber* self, usize timeout_ms, void** result); // false if `self` didn't finish in time
 
 void Fiber_Sleep(usize time_ms);
-void Fiber_Yield(void);
-int  Fiber_WaitUntil(int fd, int ev_mask);
+void Fiber_Yield(void); // no-op outside of a fiber
+int  Fiber_WaitUntil(int fd, int ev_mask); // EPOLLIN/EPOLLOUT/..., returns the ready events or -1 w/ errno
+int  Fiber_WaitUntilTimeout(int fd, int ev_mask, usize timeout_ms); // same, 0 if the fd isn't ready in time
+
+Fiber* Fiber_Current(void); // NULL outside of a fiber
+
+/* --- Fiber I/O --- */
+// Same results as the syscalls (-1 w/ errno on failure), but only the calling fiber blocks. `offset` < 0 uses
+// (and advances) the file position, like read/write.
+
+isize Fiber_Read(int fd, void* buf, usize len, i64 offset);
+isize Fiber_Write(int fd, const void* buf, usize len, i64 offset);
+int   Fiber_Accept(int fd, struct sockaddr* addr, socklen_t* addrlen);
 
 #define Fiber_YieldUntil(cond) do { while (!(cond)) Fiber_Yield(); } while (0)
 
+/* --- Scheduler --- */
+// Stop only returns once the workers run out of runnable fibers, join every fiber before stopping. Threads that
+// started fibers without a scheduler keep running them themselves.
+
+bool FiberScheduler_Start(usize num_threads); // 0 => one worker per online CPU, workers are pinned to CPUs
+void FiberScheduler_Stop(void);
+
 // Fiber local storage?
+
+/* --- Implementation --- */
+
+typedef Fiber* FiberPtr;
+
+#define T FiberPtr
+#include <deggua/generic/steal_deque.h>
+
+#define FIBER__JOINED        ((Fiber*)~(uptr)0)
+#define FIBER__THREAD_JOINER ((Fiber*)~(uptr)1) // a thread outside the scheduler is waiting on Fiber__thread_joins
+
+// work left for the context that was switched to, the previous fiber is still on its stack until the switch
+#define FIBER__PENDING_NONE    (0)
+#define FIBER__PENDING_REQUEUE (1) // yielded, make it runnable again
+#define FIBER__PENDING_JOIN    (2) // blocked in Fiber_Join, register as the joiner of `pending_arg`
+#define FIBER__PENDING_EXIT    (3) // finished, wake the joiner
+#define FIBER__PENDING_WAIT_FD (4) // blocked in Fiber_WaitUntil, arm its fd in the reactor
+#define FIBER__PENDING_IO      (5) // blocked in fiber I/O, queue the SQE in `pending_arg` to the ring
+#define FIBER__PENDING_SLEEP   (6) // sleeping, add its timer to the wheel
+
+#define FIBER__TIMER_NONE    (0)
+#define FIBER__TIMER_SLEEP   (1)
+#define FIBER__TIMER_WAIT_FD (2) // disarms the fd when it fires
+#define FIBER__TIMER_JOIN    (3) // the fiber unregisters itself as the joiner when it resumes
+
+#define FIBER__TIMER_BITS  (6)
+#define FIBER__TIMER_SLOTS (64)
+#define FIBER__TIMER_SPAN  ((U64_C(1) << (FIBER_TIMER_LEVELS * FIBER__TIMER_BITS)) - 1) // ms covered by the levels
+#define FIBER__TIMED_OUT   (-ETIMEDOUT) // `wait_result` of a wait ended by its timer
+#define FIBER__RING_FULL   (INT32_MIN)  // `wait_result` of an operation the ring had no room for
+
+#define FIBER__EVENT_FD (U64_C(1) << 63) // epoll data of a waited on fd is FIBER__EVENT_FD | fd, pointers otherwise
+
+#define FIBER__RING_UNTRIED     (0)
+#define FIBER__RING_READY       (1)
+#define FIBER__RING_UNAVAILABLE (2)
+
+#define FIBER__INJECT_INTERVAL (61) // scheduling rounds between checks of the shared queue/reactor ahead of the local deque
+
+// intrusive FIFO of fibers, for fibers started outside the workers and overflow from full deques
+typedef struct {
+    Fiber* head;
+    Fiber* tail;
+    u32    lock;
+} FiberQueue;
+
+typedef struct {
+    int                  fd;
+    u32                  state;    // FIBER__RING_*
+    u32                  queued;   // SQEs written but not submitted yet
+    usize                inflight; // submitted operations without a completion
+    u32                  cq_entries; // cap on queued + inflight so completions never overflow the CQ
+    u32*                 sq_flags;
+    u32*                 sq_head;
+    u32*                 sq_tail;
+    u32*                 sq_array;
+    u32                  sq_mask;
+    struct io_uring_sqe* sqes;
+    u32*                 cq_head;
+    u32*                 cq_tail;
+    u32                  cq_mask;
+    struct io_uring_cqe* cqes;
+    void*                sq_map;
+    usize                sq_map_size;
+    void*                cq_map; // same as `sq_map` with IORING_FEAT_SINGLE_MMAP
+    usize                cq_map_size;
+    usize                sqes_size;
+} FiberRing;
+
+typedef struct {
+    FiberTimer slots[FIBER_TIMER_LEVELS][FIBER__TIMER_SLOTS]; // list sentinels
+    FiberTimer overflow;                                      // timers past the end of the current span
+    u64        occupied[FIBER_TIMER_LEVELS];                  // non-empty slots
+    u64        now;                                           // ms, every timer up to `now` has fired
+    usize      count;
+} FiberTimerWheel;
+
+// fibers parked on one fd in a worker's reactor
+typedef struct {
+    Fiber* reader; // waiting for anything but EPOLLOUT alone
+    Fiber* writer; // waiting for EPOLLOUT
+} FiberFdWaiters;
+
+struct FiberScheduler;
+
+typedef struct FiberWorker {
+    StealDeque(FiberPtr)   runnable;  // owner pushes and pops the newest, thieves take the oldest
+    Fiber*                 yielded;   // FIFO of fibers that yielded, owner only (linked through `next`)
+    Fiber*                 yielded_tail;
+    FiberQueue*            inject;    // shared queue, the scheduler's or `own_inject`
+    struct FiberScheduler* sched;     // NULL for a thread running its own fibers
+    Fiber*                 current;   // fiber running on this thread, NULL in the thread's own context
+    void*                  thread_sp; // saved stack pointer of the thread's own context
+    Fiber*                 pending;   // fiber the previous context switched away from
+    void*                  pending_arg;
+    u32                    pending_op; // FIBER__PENDING_*
+    u32                    tick;
+    u64                    rng;
+    FiberQueue             own_inject;
+    pthread_t              thread;
+    int                    epoll_fd;   // reactor
+    int                    wake_fd;    // eventfd in the reactor, written to wake the worker (-1 without a scheduler)
+    usize                  io_waiters; // fibers armed in the reactor
+    FiberFdWaiters*        fd_waiters; // indexed by fd, grown on demand
+    usize                  fd_waiters_len;
+    FiberRing              ring;       // created the first time a fiber on this worker does I/O
+    FiberTimerWheel        wheel;
+
+    // written by other workers
+    u32    parked ATTR(aligned(TARGET_CACHE_LINE_SIZE)); // 1 while the worker is (about to be) asleep in epoll_wait
+    Fiber* inbox;                                        // timed waiters woken elsewhere (MPSC stack)
+} FiberWorker;
+
+typedef struct FiberScheduler {
+    FiberWorker*   workers;
+    usize          num_workers;
+    FiberQueue     inject;
+    u32            idle;     // workers parked or about to park
+    u32            stopping;
+    bool           running;
+    pthread_key_t  key;      // frees the worker of a thread running its own fibers when it exits
+    pthread_once_t once;
+} FiberScheduler;
+
+typedef struct FiberStack {
+    struct FiberStack* next;
+    usize              size;
+} FiberStack;
+
+SYM_WEAK FiberScheduler Fiber__scheduler = {.once = PTHREAD_ONCE_INIT};
+SYM_WEAK _Thread_local FiberWorker* Fiber__worker;
+SYM_WEAK u32 Fiber__thread_joins; // bumped and woken whenever a fiber joined from a thread exits, unlike the fiber it outlives the wake
+SYM_WEAK struct {
+    FiberStack* head;
+    usize       count;
+    u32         lock;
+} Fiber__stack_pool;
+
+// void Fiber__Switch(void** save_sp, void* load_sp)
+// saves the callee saved registers on the current stack, stores the stack pointer to `save_sp` and resumes the
+// context whose stack pointer is `load_sp`
+void Fiber__Switch(void** save_sp, void* load_sp);
+void Fiber__Trampoline(void);
+
+__asm__(
+    ".pushsection .text\n"
+    ".weak Fiber__Switch\n"
+    ".type Fiber__Switch, @function\n"
+    "Fiber__Switch:\n"
+    "    pushq %rbp\n"
+    "    pushq %rbx\n"
+    "    pushq %r12\n"
+    "    pushq %r13\n"
+    "    pushq %r14\n"
+    "    pushq %r15\n"
+    "    movq %rsp, (%rdi)\n"
+    "    movq %rsi, %rsp\n"
+    "    popq %r15\n"
+    "    popq %r14\n"
+    "    popq %r13\n"
+    "    popq %r12\n"
+    "    popq %rbx\n"
+    "    popq %rbp\n"
+    "    ret\n"
+    ".size Fiber__Switch, .-Fiber__Switch\n"
+    "\n"
+    // first switch into a fiber lands here with the fiber in r12
+    ".weak Fiber__Trampoline\n"
+    ".type Fiber__Trampoline, @function\n"
+    "Fiber__Trampoline:\n"
+    "    movq %r12, %rdi\n"
+    "    call Fiber__Main@PLT\n"
+    "    ud2\n"
+    ".size Fiber__Trampoline, .-Fiber__Trampoline\n"
+    ".popsection\n");
+
+// Fibers migrate between workers and can't cache the address of thread local state across a switch (the compiler
+// assumes it's constant for the duration of a function), going through a weak function forces a reload every time.
+SYM_WEAK ATTR(noinline)
+FiberWorker* Fiber__Worker(void)
+{
+    return Fiber__worker;
+}
+
+/* --- Stacks --- */
+
+static inline void Fiber__StackPoolLock(void)
+{
+    while (__atomic_exchange_n(&Fiber__stack_pool.lock, 1, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(&Fiber__stack_pool.lock, __ATOMIC_RELAXED)) {
+            CPU_RELAX();
+        }
+    }
+}
+
+static inline void Fiber__StackPoolUnlock(void)
+{
+    __atomic_store_n(&Fiber__stack_pool.lock, 0, __ATOMIC_RELEASE);
+}
+
+SYM_WEAK
+u8* Fiber__StackAlloc(usize size)
+{
+    Fiber__StackPoolLock();
+
+    // the pool is short and stacks are usually all the same size, a linear scan is fine
+    FiberStack** link = &Fiber__stack_pool.head;
+    while (*link && (*link)->size != size) link = &(*link)->next;
+
+    FiberStack* stack = *link;
+    if (stack) {
+        *link = stack->next;
+        Fiber__stack_pool.count--;
+    }
+
+    Fiber__StackPoolUnlock();
+
+    if (stack) return (u8*)stack - sysconf(_SC_PAGESIZE);
+
+    u8* mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (mapping == MAP_FAILED) return NULL;
+
+    // guard page, overflowing the stack faults instead of corrupting whatever is mapped below it
+    if (mprotect(mapping, sysconf(_SC_PAGESIZE), PROT_NONE)) {
+        munmap(mapping, size);
+        return NULL;
+    }
+
+    return mapping;
+}
+
+SYM_WEAK
+void Fiber__StackFree(u8* mapping, usize size)
+{
+    // the pool's bookkeeping lives just above the guard page, at the far end from where the stack is used
+    FiberStack* stack = (FiberStack*)(mapping + sysconf(_SC_PAGESIZE));
+    stack->size       = size;
+
+    Fiber__StackPoolLock();
+
+    bool pooled = Fiber__stack_pool.count < FIBER_STACK_POOL_MAX;
+    if (pooled) {
+        stack->next             = Fiber__stack_pool.head;
+        Fiber__stack_pool.head  = stack;
+        Fiber__stack_pool.count++;
+    }
+
+    Fiber__StackPoolUnlock();
+
+    if (!pooled) munmap(mapping, size);
+}
+
+/* --- Run Queues --- */
+
+static inline void Fiber__QueuePush(FiberQueue* queue, Fiber* fiber)
+{
+    fiber->next = NULL;
+
+    while (__atomic_exchange_n(&queue->lock, 1, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(&queue->lock, __ATOMIC_RELAXED)) {
+            CPU_RELAX();
+        }
+    }
+
+    if (queue->tail) {
+        queue->tail->next = fiber;
+    } else {
+        __atomic_store_n(&queue->head, fiber, __ATOMIC_RELAXED);
+    }
+    queue->tail = fiber;
+
+    __atomic_store_n(&queue->lock, 0, __ATOMIC_RELEASE);
+}
+
+static inline Fiber* Fiber__QueuePop(FiberQueue* queue)
+{
+    // usually empty, don't touch the lock for nothing
+    if (!__atomic_load_n(&queue->head, __ATOMIC_RELAXED)) return NULL;
+
+    while (__atomic_exchange_n(&queue->lock, 1, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(&queue->lock, __ATOMIC_RELAXED)) {
+            CPU_RELAX();
+        }
+    }
+
+    Fiber* fiber = queue->head;
+    if (fiber) {
+        __atomic_store_n(&queue->head, fiber->next, __ATOMIC_RELAXED);
+        if (!fiber->next) queue->tail = NULL;
+    }
+
+    __atomic_store_n(&queue->lock, 0, __ATOMIC_RELEASE);
+
+    return fiber;
+}
+
+static inline void Fiber__MakeRunnable(FiberWorker* worker, Fiber* fiber)
+{
+    __atomic_store_n(&fiber->state, FIBER_STATE_RUNNABLE, __ATOMIC_RELAXED);
+
+    if (!StealDeque_Push(FiberPtr)(&worker->runnable, &fiber)) {
+        Fiber__QueuePush(worker->inject, fiber);
+    }
+}
+
+static inline void Fiber__YieldPush(FiberWorker* worker, Fiber* fiber)
+{
+    __atomic_store_n(&fiber->state, FIBER_STATE_RUNNABLE, __ATOMIC_RELAXED);
+
+    fiber->next = NULL;
+    if (worker->yielded_tail) {
+        worker->yielded_tail->next = fiber;
+    } else {
+        worker->yielded = fiber;
+    }
+    worker->yielded_tail = fiber;
+}
+
+static inline Fiber* Fiber__YieldPop(FiberWorker* worker)
+{
+    Fiber* fiber = worker->yielded;
+    if (fiber) {
+        worker->yielded = fiber->next;
+        if (!fiber->next) worker->yielded_tail = NULL;
+    }
+
+    return fiber;
+}
+
+// wakes one parked worker
+SYM_WEAK
+void Fiber__WakeWorker(FiberScheduler* sched)
+{
+    for (usize ii = 0; ii < sched->num_workers; ii++) {
+        FiberWorker* worker = &sched->workers[ii];
+
+        if (__atomic_load_n(&worker->parked, __ATOMIC_RELAXED) && __atomic_exchange_n(&worker->parked, 0, __ATOMIC_ACQ_REL)) {
+            u64 one = 1;
+            UNUSED(write(worker->wake_fd, &one, sizeof(one)));
+            return;
+        }
+    }
+}
+
+// call after making fibers runnable, pairs with the idle count bump + queue recheck before parking
+static inline void Fiber__Notify(FiberScheduler* sched)
+{
+    if (!sched) return;
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&sched->idle, __ATOMIC_ACQUIRE)) Fiber__WakeWorker(sched);
+}
+
+static inline u64 Fiber__Random(FiberWorker* worker)
+{
+    // xorshift64
+    u64 xx = worker->rng;
+    xx ^= xx << 13;
+    xx ^= xx >> 7;
+    xx ^= xx << 17;
+    worker->rng = xx;
+
+    return xx;
+}
+
+/* --- io_uring --- */
+
+SYM_WEAK
+void Fiber__RingDelete(FiberRing* ring)
+{
+    if (ring->state != FIBER__RING_READY) return;
+
+    munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_map != ring->sq_map) munmap(ring->cq_map, ring->cq_map_size);
+    munmap(ring->sq_map, ring->sq_map_size);
+    close(ring->fd);
+
+    ring->state = FIBER__RING_UNTRIED;
+}
+
+SYM_WEAK
+bool Fiber__RingNew(FiberRing* ring, int epoll_fd)
+{
+#ifdef SYS_io_uring_setup
+    struct io_uring_params params;
+    memset(&params, 0x00, sizeof(params));
+
+    ring->fd = syscall(SYS_io_uring_setup, FIBER_RING_ENTRIES, &params);
+    if (ring->fd < 0) return false;
+
+    ring->sq_map_size = params.sq_off.array + params.sq_entries * sizeof(u32);
+    ring->cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->sqes_size   = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->sq_map_size = max(ring->sq_map_size, ring->cq_map_size);
+        ring->cq_map_size = ring->sq_map_size;
+    }
+
+    ring->sq_map = mmap(NULL, ring->sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    ring->cq_map = ring->sq_map;
+    ring->sqes   = MAP_FAILED;
+
+    if (ring->sq_map != MAP_FAILED && !(params.features & IORING_FEAT_SINGLE_MMAP)) {
+        ring->cq_map = mmap(NULL, ring->cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+    }
+
+    if (ring->cq_map != MAP_FAILED) {
+        ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    }
+
+    // completions show up as the ring fd becoming readable
+    struct epoll_event event = {.events = EPOLLIN, .data.ptr = ring};
+
+    if (ring->sqes == MAP_FAILED || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, ring->fd, &event)) {
+        if (ring->sqes != MAP_FAILED) munmap(ring->sqes, ring->sqes_size);
+        if (ring->cq_map != MAP_FAILED && ring->cq_map != ring->sq_map) munmap(ring->cq_map, ring->cq_map_size);
+        if (ring->sq_map != MAP_FAILED) munmap(ring->sq_map, ring->sq_map_size);
+        close(ring->fd);
+        return false;
+    }
+
+    u8* sq = ring->sq_map;
+    u8* cq = ring->cq_map;
+
+    ring->sq_flags = (u32*)(sq + params.sq_off.flags);
+    ring->sq_head  = (u32*)(sq + params.sq_off.head);
+    ring->sq_tail  = (u32*)(sq + params.sq_off.tail);
+    ring->sq_array = (u32*)(sq + params.sq_off.array);
+    ring->sq_mask  = *(u32*)(sq + params.sq_off.ring_mask);
+    ring->cq_head  = (u32*)(cq + params.cq_off.head);
+    ring->cq_tail  = (u32*)(cq + params.cq_off.tail);
+    ring->cq_mask  = *(u32*)(cq + params.cq_off.ring_mask);
+    ring->cqes     = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+    ring->queued     = 0;
+    ring->inflight   = 0;
+    ring->cq_entries = params.cq_entries;
+
+    return true;
+#else
+    UNUSED(ring);
+    UNUSED(epoll_fd);
+    return false;
+#endif
+}
+
+// the worker's ring, set up on first use
+static inline bool Fiber__RingReady(FiberWorker* worker)
+{
+    FiberRing* ring = &worker->ring;
+
+    if (unlikely(ring->state == FIBER__RING_UNTRIED)) {
+        ring->state = Fiber__RingNew(ring, worker->epoll_fd) ? FIBER__RING_READY : FIBER__RING_UNAVAILABLE;
+    }
+
+    return ring->state == FIBER__RING_READY;
+}
+
+SYM_WEAK
+void Fiber__RingSubmit(FiberRing* ring)
+{
+#ifdef SYS_io_uring_enter
+    while (ring->queued) {
+        int submitted = syscall(SYS_io_uring_enter, ring->fd, ring->queued, 0, 0, NULL, 0);
+        if (submitted < 0) {
+            // EAGAIN/EBUSY: the kernel is backed up on completions, try again once some are reaped
+            if (errno == EINTR) continue;
+            return;
+        }
+
+        ring->queued   -= submitted;
+        ring->inflight += submitted;
+    }
+#else
+    UNUSED(ring);
+#endif
+}
+
+static inline usize Fiber__RingHarvest(FiberWorker* worker)
+{
+    FiberRing* ring = &worker->ring;
+
+    u32 head = *ring->cq_head;
+    u32 tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+
+    for (u32 ii = head; ii != tail; ii++) {
+        struct io_uring_cqe* cqe   = &ring->cqes[ii & ring->cq_mask];
+        Fiber*               fiber = (Fiber*)(uptr)cqe->user_data;
+
+        fiber->wait_result = cqe->res;
+        Fiber__MakeRunnable(worker, fiber);
+    }
+
+    __atomic_store_n(ring->cq_head, tail, __ATOMIC_RELEASE);
+    ring->inflight -= tail - head;
+
+    return tail - head;
+}
+
+// makes the fibers with completed operations runnable, returns how many
+SYM_WEAK
+usize Fiber__RingReap(FiberWorker* worker)
+{
+    FiberRing* ring  = &worker->ring;
+    usize      woken = Fiber__RingHarvest(worker);
+
+#ifdef SYS_io_uring_enter
+    // completions that didn't fit in the CQ wait in the kernel until they're asked for (inflight is capped at the CQ
+    // size so this shouldn't happen, but they'd be lost for good otherwise)
+    if (unlikely(__atomic_load_n(ring->sq_flags, __ATOMIC_ACQUIRE) & IORING_SQ_CQ_OVERFLOW)) {
+        if (syscall(SYS_io_uring_enter, ring->fd, 0, 0, IORING_ENTER_GETEVENTS, NULL, 0) >= 0) {
+            woken += Fiber__RingHarvest(worker);
+        }
+    }
+#endif
+
+    return woken;
+}
+
+// copies `sqe` into the ring for `fiber`, it's submitted with the rest of the batch, false if the ring has no room
+// for it (or its completion) even after submitting and reaping what it can
+SYM_WEAK
+bool Fiber__RingQueue(FiberWorker* worker, Fiber* fiber, const struct io_uring_sqe* sqe)
+{
+    FiberRing* ring = &worker->ring;
+
+    if (ring->queued + ring->inflight >= ring->cq_entries && ring->inflight) Fiber__RingReap(worker);
+    if (ring->queued + ring->inflight >= ring->cq_entries) return false;
+
+    u32 tail = *ring->sq_tail;
+
+    // full, everything queued is consumed by the kernel on submit unless it's backed up (EAGAIN/EBUSY)
+    if (tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) > ring->sq_mask) {
+        Fiber__RingSubmit(ring);
+        if (tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) > ring->sq_mask) return false;
+    }
+
+    u32 index = tail & ring->sq_mask;
+
+    ring->sqes[index]           = *sqe;
+    ring->sqes[index].user_data = (uptr)fiber;
+    ring->sq_array[index]       = index;
+
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ring->queued++;
+
+    return true;
+}
+
+/* --- Fd Waiters --- */
+
+static inline Fiber** Fiber__FdSlot(FiberFdWaiters* waiters, u32 events)
+{
+    bool writer = (events & EPOLLOUT) && !(events & (EPOLLIN | EPOLLPRI | EPOLLRDHUP));
+    return writer ? &waiters->writer : &waiters->reader;
+}
+
+SYM_WEAK
+bool Fiber__FdWaitersGrow(FiberWorker* worker, int fd)
+{
+    usize len = max(max(worker->fd_waiters_len * 2, (usize)fd + 1), (usize)64);
+
+    FiberFdWaiters* waiters = REALLOC(worker->fd_waiters, len * sizeof(FiberFdWaiters));
+    if (!waiters) {
+        errno = ENOMEM;
+        return false;
+    }
+
+    memset(waiters + worker->fd_waiters_len, 0x00, (len - worker->fd_waiters_len) * sizeof(FiberFdWaiters));
+    worker->fd_waiters     = waiters;
+    worker->fd_waiters_len = len;
+
+    return true;
+}
+
+// (re)arms `fd` one-shot with the events of everyone still waiting on it
+static inline bool Fiber__FdRearm(FiberWorker* worker, int fd, const FiberFdWaiters* waiters)
+{
+    u32 events = (waiters->reader ? waiters->reader->wait_events : 0) | (waiters->writer ? waiters->writer->wait_events : 0);
+
+    struct epoll_event event = {
+        .events   = events | EPOLLET | EPOLLONESHOT,
+        .data.u64 = FIBER__EVENT_FD | (u32)fd,
+    };
+
+    // the fd might have been waited on from another worker's reactor before, it stays registered there (disarmed)
+    if (epoll_ctl(worker->epoll_fd, EPOLL_CTL_MOD, fd, &event)) {
+        if (errno != ENOENT || epoll_ctl(worker->epoll_fd, EPOLL_CTL_ADD, fd, &event)) return false;
+    }
+
+    return true;
+}
+
+// takes a fiber whose timer fired off its fd
+static inline void Fiber__FdCancel(FiberWorker* worker, Fiber* fiber)
+{
+    FiberFdWaiters* waiters = &worker->fd_waiters[fiber->wait_fd];
+    *(waiters->reader == fiber ? &waiters->reader : &waiters->writer) = NULL;
+
+    // with nobody left drop the registration so a late event can't wake a later wait, otherwise it stays armed for
+    // the other waiter (an event that was only for this one just re-arms it)
+    if (!waiters->reader && !waiters->writer) epoll_ctl(worker->epoll_fd, EPOLL_CTL_DEL, fiber->wait_fd, NULL);
+
+    worker->io_waiters--;
+}
+
+/* --- Timers --- */
+
+static inline u64 Fiber__NowMs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (u64)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+static inline u64 Fiber__Deadline(usize timeout_ms)
+{
+    u64 now = Fiber__NowMs();
+    return timeout_ms < UINT64_MAX - now ? now + timeout_ms : UINT64_MAX - 1;
+}
+
+SYM_WEAK
+void Fiber__WheelInit(FiberTimerWheel* wheel)
+{
+    for (usize level = 0; level < FIBER_TIMER_LEVELS; level++) {
+        for (usize slot = 0; slot < FIBER__TIMER_SLOTS; slot++) {
+            wheel->slots[level][slot].prev = &wheel->slots[level][slot];
+            wheel->slots[level][slot].next = &wheel->slots[level][slot];
+        }
+
+        wheel->occupied[level] = 0;
+    }
+
+    wheel->overflow.prev = &wheel->overflow;
+    wheel->overflow.next = &wheel->overflow;
+
+    wheel->now   = Fiber__NowMs();
+    wheel->count = 0;
+}
+
+// files the timer in the slot for its expiry relative to `now`: the level is the highest 6 bit group where the two
+// differ, so the slot is reached (and cascaded into lower levels) as `now` advances
+static inline void Fiber__TimerLink(FiberTimerWheel* wheel, FiberTimer* timer)
+{
+    u64   expires = max(timer->expires, wheel->now);
+    u64   diff    = expires ^ wheel->now;
+    usize level   = diff ? ilog2_64(diff) / FIBER__TIMER_BITS : 0;
+    usize slot    = 0;
+
+    FiberTimer* head;
+    if (level < FIBER_TIMER_LEVELS) {
+        slot = (expires >> (level * FIBER__TIMER_BITS)) & (FIBER__TIMER_SLOTS - 1);
+        head = &wheel->slots[level][slot];
+
+        wheel->occupied[level] |= U64_C(1) << slot;
+    } else {
+        level = FIBER_TIMER_LEVELS;
+        head  = &wheel->overflow;
+    }
+
+    timer->level     = level;
+    timer->slot      = slot;
+    timer->prev      = head->prev;
+    timer->next      = head;
+    head->prev->next = timer;
+    head->prev       = timer;
+}
+
+static inline void Fiber__TimerUnlink(FiberTimerWheel* wheel, FiberTimer* timer)
+{
+    timer->prev->next = timer->next;
+    timer->next->prev = timer->prev;
+
+    if (timer->level == FIBER_TIMER_LEVELS) return;
+
+    FiberTimer* head = &wheel->slots[timer->level][timer->slot];
+    if (head->next == head) wheel->occupied[timer->level] &= ~(U64_C(1) << timer->slot);
+}
+
+static inline void Fiber__TimerAdd(FiberWorker* worker, Fiber* fiber, u8 kind)
+{
+    FiberTimerWheel* wheel = &worker->wheel;
+
+    // an empty wheel may not have been advanced in a while
+    if (!wheel->count) wheel->now = Fiber__NowMs();
+
+    fiber->timer.kind  = kind;
+    fiber->timer.owner = worker;
+
+    Fiber__TimerLink(wheel, &fiber->timer);
+    wheel->count++;
+}
+
+static inline void Fiber__TimerCancel(FiberWorker* worker, Fiber* fiber)
+{
+    if (fiber->timer.kind == FIBER__TIMER_NONE) return;
+
+    Fiber__TimerUnlink(&worker->wheel, &fiber->timer);
+    worker->wheel.count--;
+
+    fiber->timer.kind = FIBER__TIMER_NONE;
+}
+
+// earliest time the wheel has work to do (a timer firing or a slot cascading), UINT64_MAX if it's empty
+SYM_WEAK
+u64 Fiber__WheelNext(const FiberTimerWheel* wheel)
+{
+    u64 next = UINT64_MAX;
+
+    for (usize level = 0; level < FIBER_TIMER_LEVELS; level++) {
+        usize shift = level * FIBER__TIMER_BITS;
+        usize index = (wheel->now >> shift) & (FIBER__TIMER_SLOTS - 1);
+
+        // level 0 slots are due on their tick, higher levels once `now` reaches the start of the slot
+        u64 slots = wheel->occupied[level];
+        if (level) {
+            slots &= index == FIBER__TIMER_SLOTS - 1 ? 0 : ~U64_C(0) << (index + 1);
+        } else {
+            slots &= ~U64_C(0) << index;
+        }
+
+        if (!slots) continue;
+
+        u64 base = wheel->now >> (shift + FIBER__TIMER_BITS) << (shift + FIBER__TIMER_BITS);
+        next     = min(next, base | ((u64)ctz_64(slots) << shift));
+    }
+
+    // the overflow list is refiled when the next span starts
+    if (next == UINT64_MAX && wheel->overflow.next != &wheel->overflow) next = (wheel->now | FIBER__TIMER_SPAN) + 1;
+
+    return next;
+}
+
+// ms until the wheel has work to do, -1 if it's empty
+static inline int Fiber__WheelTimeout(FiberWorker* worker)
+{
+    if (!worker->wheel.count) return -1;
+
+    u64 next = Fiber__WheelNext(&worker->wheel);
+    u64 now  = Fiber__NowMs();
+
+    return next <= now ? 0 : (int)min(next - now, (u64)INT32_MAX);
+}
+
+SYM_WEAK
+void Fiber__TimerFire(FiberWorker* worker, Fiber* fiber)
+{
+    switch (fiber->timer.kind) {
+        case FIBER__TIMER_WAIT_FD: {
+            Fiber__FdCancel(worker, fiber);
+            fiber->wait_result = 0;
+        } break;
+
+        case FIBER__TIMER_JOIN: {
+            fiber->wait_result = FIBER__TIMED_OUT;
+        } break;
+    }
+
+    fiber->timer.kind = FIBER__TIMER_NONE;
+    Fiber__MakeRunnable(worker, fiber);
+}
+
+// moves every timer in the list at `head` to its slot relative to the current `now`
+static inline void Fiber__TimerRelink(FiberTimerWheel* wheel, FiberTimer* head)
+{
+    FiberTimer* timer = head->next;
+
+    head->prev = head;
+    head->next = head;
+
+    while (timer != head) {
+        FiberTimer* later = timer->next;
+        Fiber__TimerLink(wheel, timer);
+        timer = later;
+    }
+}
+
+// fires every timer due by `now`, returns how many
+SYM_WEAK
+usize Fiber__WheelAdvance(FiberWorker* worker, u64 now)
+{
+    FiberTimerWheel* wheel = &worker->wheel;
+    usize            fired = 0;
+
+    for (;;) {
+        u64 next = Fiber__WheelNext(wheel);
+        if (next > now) break;
+
+        wheel->now = next;
+
+        if (!(next & FIBER__TIMER_SPAN)) Fiber__TimerRelink(wheel, &wheel->overflow);
+
+        // slots reached at higher levels are refiled relative to the new `now`, landing in lower levels
+        for (usize level = FIBER_TIMER_LEVELS - 1; level > 0; level--) {
+            usize shift = level * FIBER__TIMER_BITS;
+            if (next & ((U64_C(1) << shift) - 1)) continue;
+
+            usize slot = (next >> shift) & (FIBER__TIMER_SLOTS - 1);
+            if (!(wheel->occupied[level] & (U64_C(1) << slot))) continue;
+
+            wheel->occupied[level] &= ~(U64_C(1) << slot);
+            Fiber__TimerRelink(wheel, &wheel->slots[level][slot]);
+        }
+
+        FiberTimer* head = &wheel->slots[0][next & (FIBER__TIMER_SLOTS - 1)];
+        while (head->next != head) {
+            FiberTimer* timer = head->next;
+
+            Fiber__TimerUnlink(wheel, timer);
+            wheel->count--;
+
+            Fiber__TimerFire(worker, containerof(timer, Fiber, timer));
+            fired++;
+        }
+    }
+
+    wheel->now = max(wheel->now, now);
+
+    return fired;
+}
+
+// wakes a fiber blocked in a timed join, only the worker owning its timer may cancel it
+SYM_WEAK
+void Fiber__WakeTimed(FiberWorker* worker, Fiber* fiber)
+{
+    FiberWorker* owner = fiber->timer.owner;
+
+    if (owner == worker) {
+        // the timer fired already if it's not in the wheel anymore, the fiber is awake
+        if (fiber->timer.kind == FIBER__TIMER_NONE) return;
+
+        Fiber__TimerCancel(worker, fiber);
+        Fiber__MakeRunnable(worker, fiber);
+        return;
+    }
+
+    __atomic_store_n(&fiber->inbox_pending, 1, __ATOMIC_RELAXED);
+
+    Fiber* head = __atomic_load_n(&owner->inbox, __ATOMIC_RELAXED);
+    do {
+        fiber->inbox_next = head;
+    } while (!__atomic_compare_exchange_n(&owner->inbox, &head, fiber, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+    if (__atomic_load_n(&owner->parked, __ATOMIC_RELAXED) && __atomic_exchange_n(&owner->parked, 0, __ATOMIC_ACQ_REL)) {
+        u64 one = 1;
+        UNUSED(write(owner->wake_fd, &one, sizeof(one)));
+    }
+}
+
+// wakes the fibers other workers handed us, unless their timer beat them to it
+SYM_WEAK
+usize Fiber__DrainInbox(FiberWorker* worker)
+{
+    Fiber* fiber = __atomic_exchange_n(&worker->inbox, NULL, __ATOMIC_ACQUIRE);
+    usize  woken = 0;
+
+    while (fiber) {
+        Fiber* next  = fiber->inbox_next;
+        bool   armed = fiber->timer.kind != FIBER__TIMER_NONE;
+
+        Fiber__TimerCancel(worker, fiber);
+
+        // before it can run again, a fiber whose timer won waits for this to go away
+        __atomic_store_n(&fiber->inbox_pending, 0, __ATOMIC_RELEASE);
+
+        if (armed) {
+            Fiber__MakeRunnable(worker, fiber);
+            woken++;
+        }
+
+        fiber = next;
+    }
+
+    return woken;
+}
+
+/* --- Reactor --- */
+
+static inline bool Fiber__HasWaiters(FiberWorker* worker)
+{
+    return worker->io_waiters || worker->ring.queued || worker->ring.inflight || worker->wheel.count
+        || __atomic_load_n(&worker->inbox, __ATOMIC_RELAXED);
+}
+
+static inline void Fiber__FdWake(FiberWorker* worker, Fiber** slot, int result, int error)
+{
+    Fiber* fiber = *slot;
+    *slot        = NULL;
+
+    fiber->wait_result = result;
+    fiber->wait_errno  = error;
+    worker->io_waiters--;
+
+    Fiber__TimerCancel(worker, fiber);
+    Fiber__MakeRunnable(worker, fiber);
+}
+
+// wakes the waiters of `fd` whose events are in `events`, returns how many
+SYM_WEAK
+usize Fiber__FdReady(FiberWorker* worker, int fd, u32 events)
+{
+    FiberFdWaiters* waiters = &worker->fd_waiters[fd];
+    usize           woken   = 0;
+
+    if (waiters->reader && (events & (waiters->reader->wait_events | EPOLLERR | EPOLLHUP))) {
+        Fiber__FdWake(worker, &waiters->reader, events, 0);
+        woken++;
+    }
+
+    if (waiters->writer && (events & (waiters->writer->wait_events | EPOLLERR | EPOLLHUP))) {
+        Fiber__FdWake(worker, &waiters->writer, events, 0);
+        woken++;
+    }
+
+    // the one-shot registration fired, whoever is left needs it armed again
+    if ((waiters->reader || waiters->writer) && !Fiber__FdRearm(worker, fd, waiters)) {
+        int error = errno;
+
+        if (waiters->reader) {
+            Fiber__FdWake(worker, &waiters->reader, -1, error);
+            woken++;
+        }
+
+        if (waiters->writer) {
+            Fiber__FdWake(worker, &waiters->writer, -1, error);
+            woken++;
+        }
+    }
+
+    return woken;
+}
+
+// harvests the reactor (and the ring), returns true if any fibers were made runnable
+SYM_WEAK
+bool Fiber__Poll(FiberWorker* worker, int timeout_ms)
+{
+    struct epoll_event events[FIBER_REACTOR_BATCH];
+
+    usize woken = worker->ring.inflight ? Fiber__RingReap(worker) : 0;
+
+    if (__atomic_load_n(&worker->inbox, __ATOMIC_RELAXED)) woken += Fiber__DrainInbox(worker);
+
+    // a non-blocking poll with nothing armed in the reactor is answered by the ring alone
+    if (timeout_ms || worker->io_waiters) {
+        int count = epoll_wait(worker->epoll_fd, events, FIBER_REACTOR_BATCH, woken ? 0 : timeout_ms);
+
+        for (int ii = 0; ii < count; ii++) {
+            u64 data = events[ii].data.u64;
+
+            if (data & FIBER__EVENT_FD) {
+                woken += Fiber__FdReady(worker, (int)(u32)data, events[ii].events);
+            } else if (events[ii].data.ptr == &worker->ring) {
+                woken += Fiber__RingReap(worker);
+            } else {
+                u64 value;
+                UNUSED(read(worker->wake_fd, &value, sizeof(value)));
+            }
+        }
+    }
+
+    if (worker->wheel.count) woken += Fiber__WheelAdvance(worker, Fiber__NowMs());
+
+    // this worker picks up one of them itself
+    if (woken > 1) Fiber__Notify(worker->sched);
+
+    return woken;
+}
+
+// owner side of the deque, the newest woken fiber first (its waker's data is still in cache)
+static inline Fiber* Fiber__PopLocal(FiberWorker* worker)
+{
+    Fiber* fiber;
+
+    // only the owner writes `bottom` and thieves only move `top` up, so seeing them equal means empty for good and
+    // Pop's fence can be skipped (the common case for a yield)
+    usize bottom = __atomic_load_n(&worker->runnable.bottom, __ATOMIC_RELAXED);
+    usize top    = __atomic_load_n(&worker->runnable.top, __ATOMIC_RELAXED);
+    if ((isize)(bottom - top) <= 0) return NULL;
+
+    return StealDeque_Pop(FiberPtr)(&worker->runnable, &fiber) ? fiber : NULL;
+}
+
+// next fiber to run: own deque, yielded fibers, the shared queue, the reactor, then the deques of other workers
+SYM_WEAK
+Fiber* Fiber__Take(FiberWorker* worker)
+{
+    Fiber* fiber;
+
+    // every so often look at the yielded fibers, the shared queue and the reactor first, fibers waking each other
+    // in the deque can't starve them
+    if (unlikely(++worker->tick % FIBER__INJECT_INTERVAL == 0)) {
+        if (worker->ring.queued) Fiber__RingSubmit(&worker->ring);
+        if (Fiber__HasWaiters(worker)) Fiber__Poll(worker, 0);
+        if ((fiber = Fiber__QueuePop(worker->inject))) return fiber;
+        if ((fiber = Fiber__YieldPop(worker))) return fiber;
+    }
+
+    if ((fiber = Fiber__PopLocal(worker))) return fiber;
+    if ((fiber = Fiber__YieldPop(worker))) return fiber;
+    if ((fiber = Fiber__QueuePop(worker->inject))) return fiber;
+
+    // every runnable fiber had its turn, submit the I/O they queued as one batch
+    if (worker->ring.queued) Fiber__RingSubmit(&worker->ring);
+
+    if (Fiber__HasWaiters(worker) && Fiber__Poll(worker, 0) && (fiber = Fiber__PopLocal(worker))) return fiber;
+
+    FiberScheduler* sched = worker->sched;
+    if (!sched) return NULL;
+
+    usize count = sched->num_workers;
+    usize start = Fiber__Random(worker) % count;
+
+    for (usize ii = 0; ii < count; ii++) {
+        FiberWorker* victim = &sched->workers[(start + ii) % count];
+        if (victim != worker && StealDeque_Steal(FiberPtr)(&victim->runnable, &fiber)) return fiber;
+    }
+
+    return NULL;
+}
+
+/* --- Switching --- */
+
+// parks `fiber` on `fiber->wait_fd` in the worker's reactor, the registration is one-shot so it's re-armed on every wait
+static inline bool Fiber__Arm(FiberWorker* worker, Fiber* fiber)
+{
+    int fd = fiber->wait_fd;
+    if (fd < 0) {
+        errno = EBADF;
+        return false;
+    }
+
+    if ((usize)fd >= worker->fd_waiters_len && !Fiber__FdWaitersGrow(worker, fd)) return false;
+
+    FiberFdWaiters* waiters = &worker->fd_waiters[fd];
+    Fiber**         slot    = Fiber__FdSlot(waiters, fiber->wait_events);
+
+    // one registration per fd, a second reader (or writer) would take the first one's place
+    if (*slot) {
+        errno = EBUSY;
+        return false;
+    }
+
+    *slot = fiber;
+    if (!Fiber__FdRearm(worker, fd, waiters)) {
+        *slot = NULL;
+        return false;
+    }
+
+    worker->io_waiters++;
+    return true;
+}
+
+// finishes whatever the context we switched away from asked for, runs first thing after every switch
+static inline void Fiber__AfterSwitch(void)
+{
+    FiberWorker* worker = Fiber__Worker();
+
+    Fiber* fiber = worker->pending;
+    void*  arg   = worker->pending_arg;
+    u32    op    = worker->pending_op;
+
+    worker->pending_op = FIBER__PENDING_NONE;
+
+    switch (op) {
+        case FIBER__PENDING_REQUEUE: {
+            // yielded fibers stay with this worker unless another one is idle and could steal them
+            FiberScheduler* sched = worker->sched;
+            if (sched && __atomic_load_n(&sched->idle, __ATOMIC_RELAXED)) {
+                Fiber__MakeRunnable(worker, fiber);
+                Fiber__Notify(sched);
+            } else {
+                Fiber__YieldPush(worker, fiber);
+            }
+        } break;
+
+        case FIBER__PENDING_JOIN: {
+            // the timer goes in first, the target can wake us as soon as we're its joiner
+            bool timed = fiber->timer.expires != UINT64_MAX;
+            if (timed) Fiber__TimerAdd(worker, fiber, FIBER__TIMER_JOIN);
+
+            // the target may finish concurrently, whoever loses the CAS knows the other side is done
+            Fiber* target   = arg;
+            Fiber* expected = NULL;
+            if (!__atomic_compare_exchange_n(&target->joiner, &expected, fiber, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                if (timed) Fiber__TimerCancel(worker, fiber);
+                Fiber__MakeRunnable(worker, fiber);
+            }
+        } break;
+
+        case FIBER__PENDING_EXIT: {
+            Fiber* joiner = __atomic_exchange_n(&fiber->joiner, FIBER__JOINED, __ATOMIC_ACQ_REL);
+            if (joiner && joiner != FIBER__THREAD_JOINER) {
+                if (joiner->timer.expires != UINT64_MAX) {
+                    Fiber__WakeTimed(worker, joiner);
+                } else {
+                    Fiber__MakeRunnable(worker, joiner);
+                }
+
+                Fiber__Notify(worker->sched);
+            }
+
+            // the joiner may free the fiber as soon as it sees this, it's the last access
+            __atomic_store_n(&fiber->state, FIBER_STATE_DONE, __ATOMIC_RELEASE);
+
+            if (joiner == FIBER__THREAD_JOINER) {
+                __atomic_add_fetch(&Fiber__thread_joins, 1, __ATOMIC_RELEASE);
+                Futex_Wake(&Fiber__thread_joins, INT32_MAX);
+            }
+        } break;
+
+        case FIBER__PENDING_WAIT_FD: {
+            if (!Fiber__Arm(worker, fiber)) {
+                fiber->wait_result = -1;
+                fiber->wait_errno  = errno;
+                Fiber__MakeRunnable(worker, fiber);
+            } else if (fiber->timer.expires != UINT64_MAX) {
+                Fiber__TimerAdd(worker, fiber, FIBER__TIMER_WAIT_FD);
+            }
+        } break;
+
+        case FIBER__PENDING_IO: {
+            if (!Fiber__RingQueue(worker, fiber, arg)) {
+                fiber->wait_result = FIBER__RING_FULL;
+                Fiber__MakeRunnable(worker, fiber);
+            }
+        } break;
+
+        case FIBER__PENDING_SLEEP: {
+            Fiber__TimerAdd(worker, fiber, FIBER__TIMER_SLEEP);
+        } break;
+    }
+}
+
+// switches from the running fiber to `next` (or the thread's own context if NULL), leaving `op` for it
+static inline void Fiber__SwitchTo(FiberWorker* worker, Fiber* self, Fiber* next, u32 op, void* arg)
+{
+    worker->pending     = self;
+    worker->pending_arg = arg;
+    worker->pending_op  = op;
+    worker->current     = next;
+
+    if (next) {
+        __atomic_store_n(&next->state, FIBER_STATE_RUNNING, __ATOMIC_RELAXED);
+        Fiber__Switch(&self->sp, next->sp);
+    } else {
+        Fiber__Switch(&self->sp, worker->thread_sp);
+    }
+
+    Fiber__AfterSwitch();
+}
+
+SYM_WEAK
+void Fiber__SwitchAway(Fiber* self, u32 op, void* arg)
+{
+    FiberWorker* worker = Fiber__Worker();
+    Fiber__SwitchTo(worker, self, Fiber__Take(worker), op, arg);
+}
+
+SYM_WEAK ATTR(noreturn, used)
+void Fiber__Main(Fiber* self)
+{
+    Fiber__AfterSwitch();
+
+    self->result = self->entry_point(self->arg);
+
+    Fiber__SwitchAway(self, FIBER__PENDING_EXIT, NULL);
+    __builtin_unreachable();
+}
+
+// runs `fiber` from the thread's own context until it switches back
+static inline void Fiber__Run(FiberWorker* worker, Fiber* fiber)
+{
+    worker->current = fiber;
+    __atomic_store_n(&fiber->state, FIBER_STATE_RUNNING, __ATOMIC_RELAXED);
+
+    Fiber__Switch(&worker->thread_sp, fiber->sp);
+    Fiber__AfterSwitch();
+}
+
+// runs fibers on a thread outside the scheduler until `target` finishes, false if `deadline` passes first
+SYM_WEAK
+bool Fiber__RunUntilDone(FiberWorker* worker, Fiber* target, u64 deadline)
+{
+    while (__atomic_load_n(&target->state, __ATOMIC_ACQUIRE) != FIBER_STATE_DONE) {
+        u64 now = deadline != UINT64_MAX ? Fiber__NowMs() : 0;
+        if (now >= deadline) return false;
+
+        Fiber* next = Fiber__Take(worker);
+        if (next) {
+            Fiber__Run(worker, next);
+            continue;
+        }
+
+        if (!Fiber__HasWaiters(worker) && deadline == UINT64_MAX) {
+            ABORT("Fiber_Join: nothing left to run, the fiber being joined can never finish");
+            return false;
+        }
+
+        int timeout = Fiber__WheelTimeout(worker);
+        if (deadline != UINT64_MAX) {
+            u64 left = min(deadline - now, (u64)INT32_MAX);
+            timeout  = timeout < 0 ? (int)left : (int)min((u64)timeout, left);
+        }
+
+        Fiber__Poll(worker, timeout);
+    }
+
+    return true;
+}
+
+/* --- Workers --- */
+
+SYM_WEAK
+void Fiber__OwnWorkerExit(void* arg)
+{
+    FiberWorker* worker = arg;
+
+    Fiber__worker = NULL;
+
+    Fiber__RingDelete(&worker->ring);
+    close(worker->epoll_fd);
+    StealDeque_Delete(FiberPtr)(&worker->runnable);
+    FREE(worker->fd_waiters);
+    ALIGNED_FREE(worker);
+}
+
+SYM_WEAK
+void Fiber__Init(void)
+{
+    if (pthread_key_create(&Fiber__scheduler.key, Fiber__OwnWorkerExit)) {
+        ABORT("Fiber: failed to create the thread exit key");
+    }
+}
+
+// worker for a thread that runs the fibers it starts itself
+SYM_WEAK
+FiberWorker* Fiber__OwnWorker(void)
+{
+    pthread_once(&Fiber__scheduler.once, Fiber__Init);
+
+    FiberWorker* worker = ALIGNED_MALLOC(TARGET_CACHE_LINE_SIZE, sizeof(FiberWorker));
+    if (!worker) return NULL;
+
+    memset(worker, 0x00, sizeof(*worker));
+    if (!StealDeque_New(FiberPtr)(&worker->runnable, FIBER_WORKER_QUEUE_SIZE)) {
+        ALIGNED_FREE(worker);
+        return NULL;
+    }
+
+    worker->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (worker->epoll_fd < 0) {
+        StealDeque_Delete(FiberPtr)(&worker->runnable);
+        ALIGNED_FREE(worker);
+        return NULL;
+    }
+
+    worker->wake_fd = -1;
+    worker->inject  = &worker->own_inject;
+    worker->rng    = (uptr)worker | 1;
+    Fiber__WheelInit(&worker->wheel);
+
+    pthread_setspecific(Fiber__scheduler.key, worker);
+    Fiber__worker = worker;
+
+    return worker;
+}
+
+SYM_WEAK
+void Fiber__PinToCpu(usize cpu)
+{
+    u64 mask[16] = {0};
+    mask[(cpu / 64) % 16] = U64_C(1) << (cpu % 64);
+
+    // best effort, raw syscall so this doesn't depend on _GNU_SOURCE
+    syscall(SYS_sched_setaffinity, 0, sizeof(mask), mask);
+}
+
+SYM_WEAK
+void* Fiber__WorkerMain(void* arg)
+{
+    FiberWorker*    worker = arg;
+    FiberScheduler* sched  = worker->sched;
+
+    Fiber__worker = worker;
+    Fiber__PinToCpu(worker - sched->workers);
+
+    for (;;) {
+        Fiber* next = Fiber__Take(worker);
+        if (next) {
+            Fiber__Run(worker, next);
+            continue;
+        }
+
+        if (__atomic_load_n(&sched->stopping, __ATOMIC_ACQUIRE)) break;
+
+        // announce we're going idle, then look once more so a concurrent Fiber__Notify can't be missed
+        __atomic_store_n(&worker->parked, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&sched->idle, 1, __ATOMIC_SEQ_CST);
+
+        next = Fiber__Take(worker);
+        if (!next) {
+            while (__atomic_load_n(&worker->parked, __ATOMIC_ACQUIRE) && !__atomic_load_n(&sched->stopping, __ATOMIC_ACQUIRE)) {
+                if (Fiber__Poll(worker, Fiber__WheelTimeout(worker))) break;
+            }
+        }
+
+        bool woken = !__atomic_exchange_n(&worker->parked, 0, __ATOMIC_ACQ_REL);
+        __atomic_sub_fetch(&sched->idle, 1, __ATOMIC_SEQ_CST);
+
+        if (next) {
+            // we took work meant for whoever woke us, pass the wakeup on
+            if (woken) Fiber__Notify(sched);
+            Fiber__Run(worker, next);
+        }
+    }
+
+    return NULL;
+}
+
+// deque and reactor of a scheduler worker
+SYM_WEAK
+bool Fiber__WorkerNew(FiberWorker* worker)
+{
+    if (!StealDeque_New(FiberPtr)(&worker->runnable, FIBER_WORKER_QUEUE_SIZE)) return false;
+
+    worker->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    worker->wake_fd  = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    struct epoll_event event = {.events = EPOLLIN, .data.ptr = NULL};
+    if (worker->epoll_fd < 0 || worker->wake_fd < 0 || epoll_ctl(worker->epoll_fd, EPOLL_CTL_ADD, worker->wake_fd, &event)) {
+        if (worker->epoll_fd >= 0) close(worker->epoll_fd);
+        if (worker->wake_fd >= 0) close(worker->wake_fd);
+        StealDeque_Delete(FiberPtr)(&worker->runnable);
+        return false;
+    }
+
+    Fiber__WheelInit(&worker->wheel);
+
+    return true;
+}
+
+SYM_WEAK
+void Fiber__WorkerDelete(FiberWorker* worker)
+{
+    Fiber__RingDelete(&worker->ring);
+    close(worker->epoll_fd);
+    close(worker->wake_fd);
+    StealDeque_Delete(FiberPtr)(&worker->runnable);
+    FREE(worker->fd_waiters);
+}
+
+SYM_WEAK
+bool FiberScheduler_Start(usize num_threads)
+{
+    FiberScheduler* sched = &Fiber__scheduler;
+    if (sched->running) return false;
+
+    if (!num_threads) num_threads = max(sysconf(_SC_NPROCESSORS_ONLN), 1);
+
+    usize        size    = alignp2_64(num_threads * sizeof(FiberWorker), TARGET_CACHE_LINE_SIZE);
+    FiberWorker* workers = ALIGNED_MALLOC(TARGET_CACHE_LINE_SIZE, size);
+    if (!workers) return false;
+
+    memset(workers, 0x00, size);
+
+    for (usize ii = 0; ii < num_threads; ii++) {
+        if (!Fiber__WorkerNew(&workers[ii])) {
+            while (ii--) Fiber__WorkerDelete(&workers[ii]);
+            ALIGNED_FREE(workers);
+            return false;
+        }
+
+        workers[ii].inject = &sched->inject;
+        workers[ii].sched  = sched;
+        workers[ii].rng    = (ii + 1) * U64_C(0x9E3779B97F4A7C15);
+    }
+
+    sched->workers     = workers;
+    sched->num_workers = num_threads;
+    sched->idle        = 0;
+    sched->stopping    = 0;
+    __atomic_store_n(&sched->running, true, __ATOMIC_RELEASE);
+
+    for (usize ii = 0; ii < num_threads; ii++) {
+        if (pthread_create(&workers[ii].thread, NULL, Fiber__WorkerMain, &workers[ii])) {
+            // the ones that never started are torn down here, Stop joins and deletes the rest (the shared queue is
+            // empty so they exit right away)
+            for (usize jj = ii; jj < num_threads; jj++) Fiber__WorkerDelete(&workers[jj]);
+
+            sched->num_workers = ii;
+            FiberScheduler_Stop();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+SYM_WEAK
+void FiberScheduler_Stop(void)
+{
+    FiberScheduler* sched = &Fiber__scheduler;
+    if (!sched->running) return;
+
+    __atomic_store_n(&sched->stopping, 1, __ATOMIC_RELEASE);
+
+    for (usize ii = 0; ii < sched->num_workers; ii++) {
+        u64 one = 1;
+        __atomic_store_n(&sched->workers[ii].parked, 0, __ATOMIC_RELEASE);
+        UNUSED(write(sched->workers[ii].wake_fd, &one, sizeof(one)));
+    }
+
+    for (usize ii = 0; ii < sched->num_workers; ii++) {
+        pthread_join(sched->workers[ii].thread, NULL);
+    }
+
+    for (usize ii = 0; ii < sched->num_workers; ii++) {
+        Fiber__WorkerDelete(&sched->workers[ii]);
+    }
+
+    ALIGNED_FREE(sched->workers);
+
+    sched->workers     = NULL;
+    sched->num_workers = 0;
+    __atomic_store_n(&sched->running, false, __ATOMIC_RELEASE);
+}
+
+/* --- Fibers --- */
+
+SYM_WEAK
+bool Fiber_New(Fiber* self, usize stack_size)
+{
+    usize page_size = sysconf(_SC_PAGESIZE);
+    usize size      = alignp2_64(stack_size ? stack_size : FIBER_DEFAULT_STACK_SIZE, page_size) + page_size;
+
+    u8* stack = Fiber__StackAlloc(size);
+    if (!stack) return false;
+
+    self->sp          = NULL;
+    self->stack       = stack;
+    self->stack_size  = size;
+    self->entry_point = NULL;
+    self->arg         = NULL;
+    self->result      = NULL;
+    self->next        = NULL;
+    self->joiner      = NULL;
+    self->state       = FIBER_STATE_IDLE;
+
+    self->timer.kind    = FIBER__TIMER_NONE;
+    self->timer.expires = UINT64_MAX;
+    self->inbox_pending = 0;
+
+    return true;
+}
+
+SYM_WEAK
+bool Fiber_Delete(Fiber* self)
+{
+    u32 state = __atomic_load_n(&self->state, __ATOMIC_ACQUIRE);
+    if (state != FIBER_STATE_IDLE && state != FIBER_STATE_DONE) return false;
+
+    Fiber__StackFree(self->stack, self->stack_size);
+    self->stack = NULL;
+
+    return true;
+}
+
+SYM_WEAK
+void Fiber_Start(Fiber* self, void* (*entry_point)(void* arg), void* arg)
+{
+    self->entry_point = entry_point;
+    self->arg         = arg;
+    self->result      = NULL;
+    self->joiner      = NULL;
+
+    // initial frame popped by Fiber__Switch: r15, r14, r13, r12 (= fiber), rbx, rbp, return address.
+    // The trampoline is entered with rsp 16 byte aligned, as it would be right before a call.
+    u64* sp = (u64*)(self->stack + self->stack_size) - 9;
+    sp[0]   = 0;
+    sp[1]   = 0;
+    sp[2]   = 0;
+    sp[3]   = (u64)self;
+    sp[4]   = 0;
+    sp[5]   = 0;
+    sp[6]   = (u64)Fiber__Trampoline;
+
+    self->sp = sp;
+
+    FiberWorker* worker = Fiber__Worker();
+    if (worker) {
+        Fiber__MakeRunnable(worker, self);
+        Fiber__Notify(worker->sched);
+        return;
+    }
+
+    FiberScheduler* sched = &Fiber__scheduler;
+    if (__atomic_load_n(&sched->running, __ATOMIC_ACQUIRE)) {
+        __atomic_store_n(&self->state, FIBER_STATE_RUNNABLE, __ATOMIC_RELAXED);
+        Fiber__QueuePush(&sched->inject, self);
+        Fiber__Notify(sched);
+        return;
+    }
+
+    worker = Fiber__OwnWorker();
+    if (!worker) ABORT("Fiber_Start: out of memory");
+
+    Fiber__MakeRunnable(worker, self);
+}
+
+// waits for `self` to finish, false if `deadline` (UINT64_MAX for none) passes first
+SYM_WEAK
+bool Fiber__Join(Fiber* self, u64 deadline)
+{
+    FiberWorker* worker  = Fiber__Worker();
+    Fiber*       current = worker ? worker->current : NULL;
+
+    if (__atomic_load_n(&self->state, __ATOMIC_ACQUIRE) != FIBER_STATE_DONE) {
+        if (current) {
+            current->timer.expires = deadline;
+            current->wait_result   = 0;
+
+            __atomic_store_n(&current->state, FIBER_STATE_WAITING, __ATOMIC_RELAXED);
+            Fiber__SwitchAway(current, FIBER__PENDING_JOIN, self);
+
+            if (current->wait_result == FIBER__TIMED_OUT) {
+                Fiber* expected = current;
+                if (__atomic_compare_exchange_n(&self->joiner, &expected, NULL, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                    return false;
+                }
+
+                // lost to the target's exit, its wakeup may still be on the way to our timer's worker
+                Fiber_YieldUntil(
+                    __atomic_load_n(&self->state, __ATOMIC_ACQUIRE) == FIBER_STATE_DONE
+                    && !__atomic_load_n(&current->inbox_pending, __ATOMIC_ACQUIRE));
+            }
+        } else if (worker && !worker->sched) {
+            if (!Fiber__RunUntilDone(worker, self, deadline)) return false;
+        } else {
+            // a thread outside the scheduler, sleep until the fiber's exit wakes us. The exit can't wake a futex in the
+            // fiber (we may free it as soon as we see it done), every thread joiner sleeps on the same global word
+            // instead, read before the state so an exit in between changes it and the wait returns right away
+            Fiber* expected = NULL;
+            if (__atomic_compare_exchange_n(&self->joiner, &expected, FIBER__THREAD_JOINER, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                for (;;) {
+                    u32 joins = __atomic_load_n(&Fiber__thread_joins, __ATOMIC_ACQUIRE);
+                    if (__atomic_load_n(&self->state, __ATOMIC_ACQUIRE) == FIBER_STATE_DONE) break;
+
+                    if (deadline == UINT64_MAX) {
+                        Futex_Wait(&Fiber__thread_joins, joins, NULL);
+                        continue;
+                    }
+
+                    u64 now = Fiber__NowMs();
+                    if (now >= deadline) {
+                        // once the exit took us as its joiner it's about to finish, wait for it below
+                        expected = FIBER__THREAD_JOINER;
+                        if (__atomic_compare_exchange_n(&self->joiner, &expected, NULL, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                            return false;
+                        }
+
+                        break;
+                    }
+
+                    struct timespec timeout = {
+                        .tv_sec  = (deadline - now) / 1000,
+                        .tv_nsec = (deadline - now) % 1000 * 1000000,
+                    };
+
+                    Futex_Wait(&Fiber__thread_joins, joins, &timeout);
+                }
+            }
+        }
+    }
+
+    // the joiner is woken just before the state is published, the fiber is free to reuse once we see it
+    while (__atomic_load_n(&self->state, __ATOMIC_ACQUIRE) != FIBER_STATE_DONE) {
+        CPU_RELAX();
+    }
+
+    __atomic_store_n(&self->state, FIBER_STATE_IDLE, __ATOMIC_RELAXED);
+    return true;
+}
+
+SYM_WEAK
+void* Fiber_Join(Fiber* self)
+{
+    Fiber__Join(self, UINT64_MAX);
+    return self->result;
+}
+
+SYM_WEAK
+bool Fiber_JoinTimeout(Fiber* self, usize timeout_ms, void** result)
+{
+    if (!Fiber__Join(self, Fiber__Deadline(timeout_ms))) return false;
+
+    if (result) *result = self->result;
+    return true;
+}
+
+SYM_WEAK
+void Fiber_Sleep(usize time_ms)
+{
+    FiberWorker* worker = Fiber__Worker();
+    Fiber*       self   = worker ? worker->current : NULL;
+
+    if (!self) {
+        struct timespec left = {.tv_sec = time_ms / 1000, .tv_nsec = time_ms % 1000 * 1000000};
+        while (nanosleep(&left, &left) && errno == EINTR);
+        return;
+    }
+
+    if (!time_ms) {
+        Fiber_Yield();
+        return;
+    }
+
+    self->timer.expires = Fiber__Deadline(time_ms);
+
+    __atomic_store_n(&self->state, FIBER_STATE_WAITING, __ATOMIC_RELAXED);
+    Fiber__SwitchAway(self, FIBER__PENDING_SLEEP, NULL);
+}
+
+SYM_WEAK
+void Fiber_Yield(void)
+{
+    FiberWorker* worker = Fiber__Worker();
+    if (!worker || !worker->current) return;
+
+    // nothing else to run, keep going
+    Fiber* next = Fiber__Take(worker);
+    if (!next) return;
+
+    Fiber__SwitchTo(worker, worker->current, next, FIBER__PENDING_REQUEUE, NULL);
+}
+
+// waits for `ev_mask` on `fd` until `deadline` (UINT64_MAX for none), 0 if it passes first
+SYM_WEAK
+int Fiber__WaitFd(int fd, int ev_mask, u64 deadline)
+{
+    FiberWorker* worker = Fiber__Worker();
+    Fiber*       self   = worker ? worker->current : NULL;
+
+    // plain thread, just block (poll and epoll share the event bits)
+    if (!self) {
+        struct pollfd pfd = {.fd = fd, .events = ev_mask};
+
+        int count;
+        for (;;) {
+            int timeout = -1;
+            if (deadline != UINT64_MAX) {
+                u64 now = Fiber__NowMs();
+                timeout = now < deadline ? (int)min(deadline - now, (u64)INT32_MAX) : 0;
+            }
+
+            count = poll(&pfd, 1, timeout);
+            if (count >= 0 || errno != EINTR) break;
+        }
+
+        return count <= 0 ? count : pfd.revents;
+    }
+
+    self->wait_fd       = fd;
+    self->wait_events   = ev_mask;
+    self->timer.expires = deadline;
+
+    __atomic_store_n(&self->state, FIBER_STATE_WAITING, __ATOMIC_RELAXED);
+    Fiber__SwitchAway(self, FIBER__PENDING_WAIT_FD, NULL);
+
+    if (self->wait_result < 0) errno = self->wait_errno;
+    return self->wait_result;
+}
+
+SYM_WEAK
+int Fiber_WaitUntil(int fd, int ev_mask)
+{
+    return Fiber__WaitFd(fd, ev_mask, UINT64_MAX);
+}
+
+SYM_WEAK
+int Fiber_WaitUntilTimeout(int fd, int ev_mask, usize timeout_ms)
+{
+    return Fiber__WaitFd(fd, ev_mask, Fiber__Deadline(timeout_ms));
+}
+
+// the operation as a plain syscall, for when there's no ring
+SYM_WEAK
+isize Fiber__IoSync(const struct io_uring_sqe* sqe)
+{
+    void* buf = (void*)(uptr)sqe->addr;
+    i64   off = (i64)sqe->off;
+
+    switch (sqe->opcode) {
+        case IORING_OP_READ: {
+            return off < 0 ? read(sqe->fd, buf, sqe->len) : pread(sqe->fd, buf, sqe->len, off);
+        }
+
+        case IORING_OP_WRITE: {
+            return off < 0 ? write(sqe->fd, buf, sqe->len) : pwrite(sqe->fd, buf, sqe->len, off);
+        }
+
+        case IORING_OP_ACCEPT: {
+            return accept(sqe->fd, buf, (socklen_t*)(uptr)sqe->addr2);
+        }
+    }
+
+    errno = EINVAL;
+    return -1;
+}
+
+// runs `sqe` on the worker's ring (or as a syscall), waiting for readiness whenever the fd isn't ready
+SYM_WEAK
+isize Fiber__Io(const struct io_uring_sqe* sqe, u32 ev_mask)
+{
+    for (;;) {
+        FiberWorker* worker = Fiber__Worker();
+        Fiber*       self   = worker ? worker->current : NULL;
+
+        isize result;
+        if (self && Fiber__RingReady(worker)) {
+            __atomic_store_n(&self->state, FIBER_STATE_WAITING, __ATOMIC_RELAXED);
+            Fiber__SwitchAway(self, FIBER__PENDING_IO, (void*)sqe);
+
+            result = self->wait_result;
+            if (result == FIBER__RING_FULL) {
+                // the ring was backed up, do this one as a plain (non-blocking) syscall
+                result = Fiber__IoSync(sqe);
+            } else if (result < 0) {
+                errno  = -result;
+                result = -1;
+            }
+        } else {
+            result = Fiber__IoSync(sqe);
+        }
+
+        if (result >= 0) return result;
+        if (errno == EINTR) continue;
+        if (errno != EAGAIN && errno != EWOULDBLOCK) return -1;
+
+        if (Fiber_WaitUntil(sqe->fd, ev_mask) < 0) return -1;
+    }
+}
+
+SYM_WEAK
+isize Fiber_Read(int fd, void* buf, usize len, i64 offset)
+{
+    struct io_uring_sqe sqe = {
+        .opcode = IORING_OP_READ,
+        .fd     = fd,
+        .addr   = (uptr)buf,
+        .len    = min(len, (usize)INT32_MAX),
+        .off    = (u64)offset,
+    };
+
+    return Fiber__Io(&sqe, EPOLLIN);
+}
+
+SYM_WEAK
+isize Fiber_Write(int fd, const void* buf, usize len, i64 offset)
+{
+    struct io_uring_sqe sqe = {
+        .opcode = IORING_OP_WRITE,
+        .fd     = fd,
+        .addr   = (uptr)buf,
+        .len    = min(len, (usize)INT32_MAX),
+        .off    = (u64)offset,
+    };
+
+    return Fiber__Io(&sqe, EPOLLOUT);
+}
+
+SYM_WEAK
+int Fiber_Accept(int fd, struct sockaddr* addr, socklen_t* addrlen)
+{
+    struct io_uring_sqe sqe = {
+        .opcode = IORING_OP_ACCEPT,
+        .fd     = fd,
+        .addr   = (uptr)addr,
+        .addr2  = (uptr)addrlen,
+    };
+
+    return Fiber__Io(&sqe, EPOLLIN);
+}
+
+SYM_WEAK
+Fiber* Fiber_Current(void)
+{
+    FiberWorker* worker = Fiber__Worker();
+    return worker ? worker->current : NULL;
+}
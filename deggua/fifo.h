@@ -1,15 +1,25 @@
 #pragma once
 
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
 #include <deggua/types.h>
+#include <deggua/bitops.h>
 
 typedef struct {
     usize size;
     usize capacity;
     usize head;
     u8*   base;
+    bool  mirrored; // buffer is mapped twice back to back, every region is contiguous
 } Fifo;
 
 bool Fifo_New(Fifo* self, usize min_size);
+bool Fifo_New_Mirrored(Fifo* self, usize min_size); // capacity is rounded up to the page size, Begin* always return the whole region
 void Fifo_Delete(Fifo* self);
 
 bool Fifo_Resize(Fifo* self, usize min_size);
@@ -29,3 +39,485 @@ void        Fifo_CompleteRead(Fifo* self, usize read_len);
 
 usize Fifo_BytesUsed(const Fifo* self);
 usize Fifo_BytesFree(const Fifo* self);
+
+// Transfer directly between the fifo and a file descriptor with readv/writev over both halves of the buffer.
+// Keeps going until the fifo is full/empty or the fd would block, returns the bytes transferred, 0 on EOF
+// (ReadFromFd) or when there's nothing to transfer, -1 with errno set if nothing was transferred before an
+// error (EAGAIN/EWOULDBLOCK for non-blocking fds that aren't ready).
+isize Fifo_ReadFromFd(Fifo* self, int fd);
+isize Fifo_WriteToFd(Fifo* self, int fd);
+
+/* --- Single Producer Single Consumer Fifo --- */
+// Lock-free fifo shared by exactly one producer thread and one consumer thread. The buffer is always mirrored
+// so every span is contiguous. Each side keeps a cached copy of the other side's index and only reloads it
+// (one cache miss) when the cached view can't satisfy the request.
+
+typedef struct {
+    u8*   base;     // mirrored mapping
+    usize capacity; // power of 2, multiple of the page size
+
+    usize head ATTR(aligned(TARGET_CACHE_LINE_SIZE)); // read position (free running), written by the consumer
+    usize tail_cache;                                  // consumer's last view of tail
+
+    usize tail ATTR(aligned(TARGET_CACHE_LINE_SIZE)); // write position (free running), written by the producer
+    usize head_cache;                                  // producer's last view of head
+} SpscFifo;
+
+bool SpscFifo_New(SpscFifo* self, usize min_size); // capacity is rounded up to a power of 2 >= the page size
+void SpscFifo_Delete(SpscFifo* self);
+
+// producer side, BeginWrite returns NULL if fewer than max(min_len, 1) bytes are free
+void* SpscFifo_BeginWrite(SpscFifo* self, usize min_len, usize* maxlen);
+void  SpscFifo_CompleteWrite(SpscFifo* self, usize write_len);
+usize SpscFifo_Write(SpscFifo* self, const void* data, usize len);
+bool  SpscFifo_WriteAll(SpscFifo* self, const void* data, usize len);
+
+// consumer side, BeginRead returns NULL if fewer than max(min_len, 1) bytes are available
+const void* SpscFifo_BeginRead(SpscFifo* self, usize min_len, usize* maxlen);
+void        SpscFifo_CompleteRead(SpscFifo* self, usize read_len);
+usize       SpscFifo_Read(SpscFifo* self, void* data, usize len);
+bool        SpscFifo_ReadAll(SpscFifo* self, void* data, usize len);
+
+// either side, the result may be stale by the time it's returned
+usize SpscFifo_BytesUsed(const SpscFifo* self);
+usize SpscFifo_BytesFree(const SpscFifo* self);
+
+/* --- Implementation --- */
+
+#ifndef MFD_CLOEXEC
+# define MFD_CLOEXEC (0x0001U)
+#endif
+
+// maps `capacity` bytes of shared memory twice, back to back
+SYM_WEAK
+u8* Fifo__MapMirrored(usize capacity)
+{
+    int fd = syscall(SYS_memfd_create, "fifo", MFD_CLOEXEC);
+    if (fd < 0) return NULL;
+
+    u8* base = MAP_FAILED;
+    if (ftruncate(fd, capacity)) goto done;
+
+    // reserve both halves first so nothing else can land in the second half
+    base = mmap(NULL, 2 * capacity, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) goto done;
+
+    if (mmap(base, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED
+        || mmap(base + capacity, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(base, 2 * capacity);
+        base = MAP_FAILED;
+    }
+
+done:
+    close(fd);
+    return base == MAP_FAILED ? NULL : base;
+}
+
+SYM_WEAK
+bool Fifo_New(Fifo* self, usize min_size)
+{
+    usize capacity = max(min_size, USIZE_C(1));
+
+    u8* base = MALLOC(capacity);
+    if (!base) return false;
+
+    self->size     = 0;
+    self->capacity = capacity;
+    self->head     = 0;
+    self->base     = base;
+    self->mirrored = false;
+
+    return true;
+}
+
+SYM_WEAK
+bool Fifo_New_Mirrored(Fifo* self, usize min_size)
+{
+    usize capacity = alignp2_64(max(min_size, USIZE_C(1)), sysconf(_SC_PAGESIZE));
+
+    u8* base = Fifo__MapMirrored(capacity);
+    if (!base) return false;
+
+    self->size     = 0;
+    self->capacity = capacity;
+    self->head     = 0;
+    self->base     = base;
+    self->mirrored = true;
+
+    return true;
+}
+
+SYM_WEAK
+void Fifo_Delete(Fifo* self)
+{
+    if (self->mirrored) {
+        munmap(self->base, 2 * self->capacity);
+    } else {
+        FREE(self->base);
+    }
+}
+
+SYM_WEAK
+bool Fifo_Resize(Fifo* self, usize min_size)
+{
+    Fifo resized;
+
+    bool ok = self->mirrored ? Fifo_New_Mirrored(&resized, max(min_size, self->size))
+                             : Fifo_New(&resized, max(min_size, self->size));
+    if (!ok) return false;
+
+    resized.size = Fifo_Read(self, resized.base, self->size);
+
+    Fifo_Delete(self);
+    *self = resized;
+
+    return true;
+}
+
+SYM_WEAK
+void Fifo_Clear(Fifo* self)
+{
+    self->size = 0;
+    self->head = 0;
+}
+
+SYM_WEAK
+usize Fifo_Write(Fifo* self, const void* data, usize len)
+{
+    len = min(len, Fifo_BytesFree(self));
+
+    usize written = 0;
+    while (written < len) {
+        usize span;
+        u8*   dst = Fifo_BeginWrite(self, &span);
+
+        span = min(span, len - written);
+        memcpy(dst, (const u8*)data + written, span);
+        Fifo_CompleteWrite(self, span);
+
+        written += span;
+    }
+
+    return written;
+}
+
+SYM_WEAK
+usize Fifo_Read(Fifo* self, void* data, usize len)
+{
+    len = min(len, Fifo_BytesUsed(self));
+
+    usize read = 0;
+    while (read < len) {
+        usize     span;
+        const u8* src = Fifo_BeginRead(self, &span);
+
+        span = min(span, len - read);
+        memcpy((u8*)data + read, src, span);
+        Fifo_CompleteRead(self, span);
+
+        read += span;
+    }
+
+    return read;
+}
+
+SYM_WEAK
+bool Fifo_WriteAll(Fifo* self, const void* data, usize len)
+{
+    if (Fifo_BytesFree(self) < len) return false;
+
+    Fifo_Write(self, data, len);
+    return true;
+}
+
+SYM_WEAK
+bool Fifo_ReadAll(Fifo* self, void* data, usize len)
+{
+    if (Fifo_BytesUsed(self) < len) return false;
+
+    Fifo_Read(self, data, len);
+    return true;
+}
+
+SYM_WEAK
+void* Fifo_BeginWrite(Fifo* self, usize* maxlen)
+{
+    usize tail = self->head + self->size;
+    if (tail >= self->capacity) tail -= self->capacity;
+
+    // the mirror makes the free region contiguous even when it wraps
+    *maxlen = self->mirrored ? Fifo_BytesFree(self) : min(Fifo_BytesFree(self), self->capacity - tail);
+
+    return self->base + tail;
+}
+
+SYM_WEAK
+void Fifo_CompleteWrite(Fifo* self, usize write_len)
+{
+    self->size += write_len;
+}
+
+SYM_WEAK
+const void* Fifo_BeginRead(Fifo* self, usize* maxlen)
+{
+    *maxlen = self->mirrored ? self->size : min(self->size, self->capacity - self->head);
+
+    return self->base + self->head;
+}
+
+SYM_WEAK
+void Fifo_CompleteRead(Fifo* self, usize read_len)
+{
+    self->size -= read_len;
+    self->head += read_len;
+
+    if (self->head >= self->capacity) self->head -= self->capacity;
+
+    // rewind when empty so the next write gets the largest contiguous region
+    if (!self->size) self->head = 0;
+}
+
+// fills `iov` with the free region(s) of the buffer, returns the iovec count
+SYM_WEAK
+int Fifo__FreeRegions(const Fifo* self, struct iovec iov[2])
+{
+    usize free = Fifo_BytesFree(self);
+    if (!free) return 0;
+
+    usize tail = self->head + self->size;
+    if (tail >= self->capacity) tail -= self->capacity;
+
+    usize first = self->mirrored ? free : min(free, self->capacity - tail);
+
+    iov[0] = (struct iovec){.iov_base = self->base + tail, .iov_len = first};
+    iov[1] = (struct iovec){.iov_base = self->base, .iov_len = free - first};
+
+    return iov[1].iov_len ? 2 : 1;
+}
+
+// fills `iov` with the used region(s) of the buffer, returns the iovec count
+SYM_WEAK
+int Fifo__UsedRegions(const Fifo* self, struct iovec iov[2])
+{
+    if (!self->size) return 0;
+
+    usize first = self->mirrored ? self->size : min(self->size, self->capacity - self->head);
+
+    iov[0] = (struct iovec){.iov_base = self->base + self->head, .iov_len = first};
+    iov[1] = (struct iovec){.iov_base = self->base, .iov_len = self->size - first};
+
+    return iov[1].iov_len ? 2 : 1;
+}
+
+SYM_WEAK
+isize Fifo_ReadFromFd(Fifo* self, int fd)
+{
+    usize total = 0;
+
+    for (;;) {
+        struct iovec iov[2];
+
+        int niov = Fifo__FreeRegions(self, iov);
+        if (!niov) break;
+
+        usize   want = iov[0].iov_len + (niov > 1 ? iov[1].iov_len : 0);
+        ssize_t got  = readv(fd, iov, niov);
+
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            if (total) break; // report the progress, the error will show up again on the next call
+            return -1;
+        }
+
+        if (!got) break; // EOF
+
+        Fifo_CompleteWrite(self, got);
+        total += got;
+
+        // a short read means the fd is drained, skip the syscall that would just return EAGAIN
+        if ((usize)got < want) break;
+    }
+
+    return total;
+}
+
+SYM_WEAK
+isize Fifo_WriteToFd(Fifo* self, int fd)
+{
+    usize total = 0;
+
+    for (;;) {
+        struct iovec iov[2];
+
+        int niov = Fifo__UsedRegions(self, iov);
+        if (!niov) break;
+
+        usize   want = iov[0].iov_len + (niov > 1 ? iov[1].iov_len : 0);
+        ssize_t put  = writev(fd, iov, niov);
+
+        if (put < 0) {
+            if (errno == EINTR) continue;
+            if (total) break;
+            return -1;
+        }
+
+        Fifo_CompleteRead(self, put);
+        total += put;
+
+        // a short write means the fd's buffer is full
+        if ((usize)put < want) break;
+    }
+
+    return total;
+}
+
+SYM_WEAK
+usize Fifo_BytesUsed(const Fifo* self)
+{
+    return self->size;
+}
+
+SYM_WEAK
+usize Fifo_BytesFree(const Fifo* self)
+{
+    return self->capacity - self->size;
+}
+
+SYM_WEAK
+bool SpscFifo_New(SpscFifo* self, usize min_size)
+{
+    usize capacity = ceilp2_64(max(min_size, (usize)sysconf(_SC_PAGESIZE)));
+
+    u8* base = Fifo__MapMirrored(capacity);
+    if (!base) return false;
+
+    self->base       = base;
+    self->capacity   = capacity;
+    self->head       = 0;
+    self->tail_cache = 0;
+    self->tail       = 0;
+    self->head_cache = 0;
+
+    return true;
+}
+
+SYM_WEAK
+void SpscFifo_Delete(SpscFifo* self)
+{
+    munmap(self->base, 2 * self->capacity);
+}
+
+SYM_WEAK
+void* SpscFifo_BeginWrite(SpscFifo* self, usize min_len, usize* maxlen)
+{
+    usize tail = self->tail;
+    usize free = self->capacity - (tail - self->head_cache);
+
+    min_len = max(min_len, USIZE_C(1));
+    if (free < min_len) {
+        self->head_cache = __atomic_load_n(&self->head, __ATOMIC_ACQUIRE);
+        free             = self->capacity - (tail - self->head_cache);
+        if (free < min_len) return NULL;
+    }
+
+    *maxlen = free;
+    return self->base + (tail & (self->capacity - 1));
+}
+
+SYM_WEAK
+void SpscFifo_CompleteWrite(SpscFifo* self, usize write_len)
+{
+    __atomic_store_n(&self->tail, self->tail + write_len, __ATOMIC_RELEASE);
+}
+
+SYM_WEAK
+usize SpscFifo_Write(SpscFifo* self, const void* data, usize len)
+{
+    usize free;
+    void* dst = SpscFifo_BeginWrite(self, 0, &free);
+    if (!dst) return 0;
+
+    len = min(len, free);
+    memcpy(dst, data, len);
+    SpscFifo_CompleteWrite(self, len);
+
+    return len;
+}
+
+SYM_WEAK
+bool SpscFifo_WriteAll(SpscFifo* self, const void* data, usize len)
+{
+    usize free;
+    void* dst = SpscFifo_BeginWrite(self, len, &free);
+    if (!dst) return false;
+
+    memcpy(dst, data, len);
+    SpscFifo_CompleteWrite(self, len);
+
+    return true;
+}
+
+SYM_WEAK
+const void* SpscFifo_BeginRead(SpscFifo* self, usize min_len, usize* maxlen)
+{
+    usize head  = self->head;
+    usize avail = self->tail_cache - head;
+
+    min_len = max(min_len, USIZE_C(1));
+    if (avail < min_len) {
+        self->tail_cache = __atomic_load_n(&self->tail, __ATOMIC_ACQUIRE);
+        avail            = self->tail_cache - head;
+        if (avail < min_len) return NULL;
+    }
+
+    *maxlen = avail;
+    return self->base + (head & (self->capacity - 1));
+}
+
+SYM_WEAK
+void SpscFifo_CompleteRead(SpscFifo* self, usize read_len)
+{
+    __atomic_store_n(&self->head, self->head + read_len, __ATOMIC_RELEASE);
+}
+
+SYM_WEAK
+usize SpscFifo_Read(SpscFifo* self, void* data, usize len)
+{
+    usize       avail;
+    const void* src = SpscFifo_BeginRead(self, 0, &avail);
+    if (!src) return 0;
+
+    len = min(len, avail);
+    memcpy(data, src, len);
+    SpscFifo_CompleteRead(self, len);
+
+    return len;
+}
+
+SYM_WEAK
+bool SpscFifo_ReadAll(SpscFifo* self, void* data, usize len)
+{
+    usize       avail;
+    const void* src = SpscFifo_BeginRead(self, len, &avail);
+    if (!src) return false;
+
+    memcpy(data, src, len);
+    SpscFifo_CompleteRead(self, len);
+
+    return true;
+}
+
+SYM_WEAK
+usize SpscFifo_BytesUsed(const SpscFifo* self)
+{
+    usize tail = __atomic_load_n(&self->tail, __ATOMIC_ACQUIRE);
+    usize head = __atomic_load_n(&self->head, __ATOMIC_ACQUIRE);
+
+    return tail - head;
+}
+
+SYM_WEAK
+usize SpscFifo_BytesFree(const SpscFifo* self)
+{
+    return self->capacity - SpscFifo_BytesUsed(self);
+}
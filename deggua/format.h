@@ -0,0 +1,1034 @@
+#pragma once
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <deggua/types.h>
+#include <deggua/bitops.h>
+#include <deggua/fifo.h>
+#include <deggua/string.h>
+
+// Type safe formatted output without format strings. Format() takes any mix of values and picks the formatter for
+// each one from its type, so there's nothing to get out of sync with the arguments:
+//
+//     Format(&sink, "GET ", path, " took ", elapsed_ms, "ms (", FMT_HEX(flags), ")\n");
+//
+// Output goes through a FormatSink over a caller buffer, a Fifo or a StringBuilder. Nothing allocates (the
+// StringBuilder sink copies into the builder's arena) and nothing depends on the locale. Integers are written two
+// digits at a time from a table, floats as the shortest decimal that parses back to the same value (Ryu).
+
+#define FORMAT_SINK_STAGE_SIZE (256) // bytes the StringBuilder sink collects before appending them
+#define FORMAT_I64_MAX         (20)  // longest Format_*ToChars output for each type
+#define FORMAT_U64_MAX         (20)
+#define FORMAT_F64_MAX         (25)
+#define FORMAT_F32_MAX         (22)
+
+typedef struct FormatSink {
+    char* at;    // next free byte of the current window
+    char* end;   // end of the current window
+    char* begin; // start of the current window
+    usize len;   // bytes formatted so far, including the ones that didn't fit
+    bool  truncated;
+    bool  (*flush)(struct FormatSink* self); // hands the window over and opens the next one, false if out of room
+    void* ctx;
+    char  stage[FORMAT_SINK_STAGE_SIZE];
+} FormatSink;
+
+typedef struct {
+    u64 value;
+    u32 width; // zero padded to at least `width` digits
+} FormatHex;
+
+#define FMT_HEX(x)            ((FormatHex){.value = (x), .width = 0})
+#define FMT_HEX_PAD(x, pad)   ((FormatHex){.value = (x), .width = (pad)})
+
+/* --- Sinks --- */
+
+void  FormatSink_Buffer(FormatSink* self, char* buf, usize size); // Truncates to `size - 1` bytes, always NUL terminated (if size > 0)
+void  FormatSink_Fifo(FormatSink* self, Fifo* fifo);              // Writes into the fifo's free space, truncates once it's full
+void  FormatSink_StringBuilder(FormatSink* self, StringBuilder* sb);
+usize FormatSink_Finish(FormatSink* self); // Completes the output, returns the bytes formatted (more than were written if truncated)
+
+/* --- Values --- */
+
+void Format_Bytes(FormatSink* self, const void* data, usize len);
+void Format_CStr(FormatSink* self, const char* cstr);
+void Format_String(FormatSink* self, const String* str);
+void Format_StringView(FormatSink* self, StringView sv);
+void Format_Char(FormatSink* self, char c);
+void Format_Bool(FormatSink* self, bool value); // "true" or "false"
+void Format_I64(FormatSink* self, i64 value);
+void Format_U64(FormatSink* self, u64 value);
+void Format_F64(FormatSink* self, f64 value);
+void Format_F32(FormatSink* self, f32 value);
+void Format_Hex(FormatSink* self, FormatHex hex); // lowercase, no prefix
+void Format_Ptr(FormatSink* self, const void* ptr);
+
+// Raw conversions, return the bytes written to `dst` which needs room for FORMAT_*_MAX bytes (no NUL)
+usize Format_U64ToChars(char* dst, u64 value);
+usize Format_I64ToChars(char* dst, i64 value);
+usize Format_F64ToChars(char* dst, f64 value); // Shortest round trip, plain notation for exponents in [-6, 20], "1.5e+300" outside
+usize Format_F32ToChars(char* dst, f32 value);
+
+// formats each argument by its type (up to 16), chars are written as characters and the other integer types as
+// numbers, `char*` as a NUL terminated string
+#define Format(sink, ...)                                                \
+    do {                                                                 \
+        FormatSink* format_sink_ = (sink);                               \
+        FORMAT__EACH(FORMAT__ARG, format_sink_, __VA_ARGS__)             \
+    } while (0)
+
+// snprintf replacement, evaluates to the formatted length
+#define Format_ToBuffer(buf, size, ...)                                  \
+    ({                                                                   \
+        FormatSink format_buffer_;                                       \
+        FormatSink_Buffer(&format_buffer_, (buf), (size));               \
+        Format(&format_buffer_, __VA_ARGS__);                            \
+        FormatSink_Finish(&format_buffer_);                              \
+    })
+
+/* --- Implementation --- */
+
+#define FORMAT__ARG(sink, x)              \
+    _Generic((x),                         \
+        bool:               Format_Bool,  \
+        char:               Format_Char,  \
+        signed char:        Format_I64,   \
+        short:              Format_I64,   \
+        int:                Format_I64,   \
+        long:               Format_I64,   \
+        long long:          Format_I64,   \
+        unsigned char:      Format_U64,   \
+        unsigned short:     Format_U64,   \
+        unsigned int:       Format_U64,   \
+        unsigned long:      Format_U64,   \
+        unsigned long long: Format_U64,   \
+        float:              Format_F32,   \
+        double:             Format_F64,   \
+        char*:              Format_CStr,  \
+        const char*:        Format_CStr,  \
+        String*:            Format_String, \
+        const String*:      Format_String, \
+        StringView:         Format_StringView, \
+        FormatHex:          Format_Hex,   \
+        void*:              Format_Ptr,   \
+        const void*:        Format_Ptr)((sink), (x));
+
+#define FORMAT__COUNT(...)  FORMAT__COUNT_(__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define FORMAT__COUNT_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, n, ...) n
+
+#define FORMAT__CONCAT(x, y)  FORMAT__CONCAT_(x, y)
+#define FORMAT__CONCAT_(x, y) x ## y
+
+#define FORMAT__EACH(f, s, ...) FORMAT__CONCAT(FORMAT__EACH_, FORMAT__COUNT(__VA_ARGS__))(f, s, __VA_ARGS__)
+#define FORMAT__EACH_1(f, s, x)       f(s, x)
+#define FORMAT__EACH_2(f, s, x, ...)  f(s, x) FORMAT__EACH_1(f, s, __VA_ARGS__)
+#define FORMAT__EACH_3(f, s, x, ...)  f(s, x) FORMAT__EACH_2(f, s, __VA_ARGS__)
+#define FORMAT__EACH_4(f, s, x, ...)  f(s, x) FORMAT__EACH_3(f, s, __VA_ARGS__)
+#define FORMAT__EACH_5(f, s, x, ...)  f(s, x) FORMAT__EACH_4(f, s, __VA_ARGS__)
+#define FORMAT__EACH_6(f, s, x, ...)  f(s, x) FORMAT__EACH_5(f, s, __VA_ARGS__)
+#define FORMAT__EACH_7(f, s, x, ...)  f(s, x) FORMAT__EACH_6(f, s, __VA_ARGS__)
+#define FORMAT__EACH_8(f, s, x, ...)  f(s, x) FORMAT__EACH_7(f, s, __VA_ARGS__)
+#define FORMAT__EACH_9(f, s, x, ...)  f(s, x) FORMAT__EACH_8(f, s, __VA_ARGS__)
+#define FORMAT__EACH_10(f, s, x, ...) f(s, x) FORMAT__EACH_9(f, s, __VA_ARGS__)
+#define FORMAT__EACH_11(f, s, x, ...) f(s, x) FORMAT__EACH_10(f, s, __VA_ARGS__)
+#define FORMAT__EACH_12(f, s, x, ...) f(s, x) FORMAT__EACH_11(f, s, __VA_ARGS__)
+#define FORMAT__EACH_13(f, s, x, ...) f(s, x) FORMAT__EACH_12(f, s, __VA_ARGS__)
+#define FORMAT__EACH_14(f, s, x, ...) f(s, x) FORMAT__EACH_13(f, s, __VA_ARGS__)
+#define FORMAT__EACH_15(f, s, x, ...) f(s, x) FORMAT__EACH_14(f, s, __VA_ARGS__)
+#define FORMAT__EACH_16(f, s, x, ...) f(s, x) FORMAT__EACH_15(f, s, __VA_ARGS__)
+
+/* --- Sinks --- */
+
+// copies what fits, then asks the sink for more room until everything is written or the sink is out of room
+SYM_WEAK ATTR(noinline)
+void Format__WriteSlow(FormatSink* self, const char* data, usize len)
+{
+    while (len && !self->truncated) {
+        usize room = self->end - self->at;
+        usize part = min(room, len);
+
+        if (part) memcpy(self->at, data, part);
+        self->at += part;
+        data     += part;
+        len      -= part;
+
+        if (len && (!self->flush || !self->flush(self))) self->truncated = true;
+    }
+}
+
+static inline void Format__Write(FormatSink* self, const char* data, usize len)
+{
+    self->len += len;
+
+    if (likely((usize)(self->end - self->at) >= len)) {
+        memcpy(self->at, data, len);
+        self->at += len;
+        return;
+    }
+
+    Format__WriteSlow(self, data, len);
+}
+
+static inline void FormatSink__Init(FormatSink* self, char* begin, char* end, bool (*flush)(FormatSink* self), void* ctx)
+{
+    self->at        = begin;
+    self->end       = end;
+    self->begin     = begin;
+    self->len       = 0;
+    self->truncated = false;
+    self->flush     = flush;
+    self->ctx       = ctx;
+}
+
+SYM_WEAK
+void FormatSink_Buffer(FormatSink* self, char* buf, usize size)
+{
+    // the last byte is kept for the terminator
+    FormatSink__Init(self, buf, size ? buf + size - 1 : buf, NULL, NULL);
+    if (!size) self->begin = NULL;
+}
+
+SYM_WEAK
+bool FormatSink__FlushFifo(FormatSink* self)
+{
+    Fifo* fifo = self->ctx;
+    Fifo_CompleteWrite(fifo, self->at - self->begin);
+
+    usize room;
+    char* window = Fifo_BeginWrite(fifo, &room);
+    if (!window || !room) {
+        self->at = self->end = self->begin = NULL;
+        return false;
+    }
+
+    self->at = self->begin = window;
+    self->end = window + room;
+
+    return true;
+}
+
+SYM_WEAK
+void FormatSink_Fifo(FormatSink* self, Fifo* fifo)
+{
+    usize room   = 0;
+    char* window = Fifo_BeginWrite(fifo, &room);
+    if (!window) room = 0;
+
+    FormatSink__Init(self, window, window + room, FormatSink__FlushFifo, fifo);
+}
+
+SYM_WEAK
+bool FormatSink__FlushStringBuilder(FormatSink* self)
+{
+    if (!StringBuilder_AppendCopy(self->ctx, self->begin, self->at - self->begin)) return false;
+
+    self->at = self->begin;
+    return true;
+}
+
+SYM_WEAK
+void FormatSink_StringBuilder(FormatSink* self, StringBuilder* sb)
+{
+    FormatSink__Init(self, self->stage, self->stage + FORMAT_SINK_STAGE_SIZE, FormatSink__FlushStringBuilder, sb);
+}
+
+SYM_WEAK
+usize FormatSink_Finish(FormatSink* self)
+{
+    if (self->flush == FormatSink__FlushFifo) {
+        if (self->begin) Fifo_CompleteWrite(self->ctx, self->at - self->begin);
+    } else if (self->flush == FormatSink__FlushStringBuilder) {
+        if (!self->truncated && !FormatSink__FlushStringBuilder(self)) self->truncated = true;
+    } else if (self->begin) {
+        *self->at = '\0';
+    }
+
+    // nothing more can be written after finishing
+    self->at = self->end = self->begin = NULL;
+    self->flush = NULL;
+
+    return self->len;
+}
+
+/* --- Integers --- */
+
+SYM_WEAK const char Format__digit_pairs[200] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+SYM_WEAK const u64 Format__pow10[20] = {
+    U64_C(1), U64_C(10), U64_C(100), U64_C(1000), U64_C(10000), U64_C(100000), U64_C(1000000), U64_C(10000000),
+    U64_C(100000000), U64_C(1000000000), U64_C(10000000000), U64_C(100000000000), U64_C(1000000000000),
+    U64_C(10000000000000), U64_C(100000000000000), U64_C(1000000000000000), U64_C(10000000000000000),
+    U64_C(100000000000000000), U64_C(1000000000000000000), U64_C(10000000000000000000u),
+};
+
+// decimal digits in `value` (1 for 0), log10 estimated from log2 (1233 / 4096 ~ log10(2)) and corrected with one compare
+static inline usize Format__DecimalLength(u64 value)
+{
+    usize estimate = ((ilog2_64(value | 1) + 1) * 1233) >> 12;
+    return estimate + ((value | 1) >= Format__pow10[estimate]);
+}
+
+// writes the `len` digits of `value` ending at dst + len
+static inline void Format__Digits(char* dst, u64 value, usize len)
+{
+    char* at = dst + len;
+
+    while (value >= 100) {
+        u64 pair = value % 100;
+        value   /= 100;
+        at      -= 2;
+        memcpy(at, &Format__digit_pairs[pair * 2], 2);
+    }
+
+    if (value >= 10) {
+        memcpy(at - 2, &Format__digit_pairs[value * 2], 2);
+    } else {
+        at[-1] = '0' + value;
+    }
+}
+
+SYM_WEAK
+usize Format_U64ToChars(char* dst, u64 value)
+{
+    usize len = Format__DecimalLength(value);
+    Format__Digits(dst, value, len);
+
+    return len;
+}
+
+SYM_WEAK
+usize Format_I64ToChars(char* dst, i64 value)
+{
+    if (value >= 0) return Format_U64ToChars(dst, value);
+
+    dst[0] = '-';
+    return 1 + Format_U64ToChars(dst + 1, -(u64)value);
+}
+
+/* --- Floats --- */
+// Ryu (Ulf Adams, "Ryu: Fast Float-to-String Conversion"). The rounding interval of the float is scaled by a power of
+// 10 with 128 bit fixed point multipliers, then digits are dropped while both ends of the interval still differ, which
+// leaves the shortest decimal inside it (the closest one if there are several). Floats go through the same code with
+// their own, wider interval, their values are exact in the double tables' range.
+
+#define FORMAT__POW5_INV_BITCOUNT (125)
+#define FORMAT__POW5_BITCOUNT     (125)
+
+typedef struct {
+    u64 mantissa;
+    i32 exponent; // value is mantissa * 10^exponent
+} FormatDecimal;
+
+// floor(2^(POW5_INV_BITCOUNT + bits(5^q) - 1) / 5^q) + 1, low 64 bits first
+SYM_WEAK const u64 Format__pow5_inv_split[342][2] = {
+    {U64_C(0x0000000000000001), U64_C(0x2000000000000000)}, {U64_C(0x999999999999999a), U64_C(0x1999999999999999)},
+    {U64_C(0x47ae147ae147ae15), U64_C(0x147ae147ae147ae1)}, {U64_C(0x6c8b4395810624de), U64_C(0x10624dd2f1a9fbe7)},
+    {U64_C(0x7a786c226809d496), U64_C(0x1a36e2eb1c432ca5)}, {U64_C(0x61f9f01b866e43ab), U64_C(0x14f8b588e368f084)},
+    {U64_C(0xb4c7f34938583622), U64_C(0x10c6f7a0b5ed8d36)}, {U64_C(0x87a6520ec08d236a), U64_C(0x1ad7f29abcaf4857)},
+    {U64_C(0x9fb841a566d74f88), U64_C(0x15798ee2308c39df)}, {U64_C(0xe62d01511f12a607), U64_C(0x112e0be826d694b2)},
+    {U64_C(0xd6ae6881cb5109a4), U64_C(0x1b7cdfd9d7bdbab7)}, {U64_C(0xdef1ed34a2a73aea), U64_C(0x15fd7fe17964955f)},
+    {U64_C(0x7f27f0f6e885c8bb), U64_C(0x119799812dea1119)}, {U64_C(0x650cb4be40d60df8), U64_C(0x1c25c268497681c2)},
+    {U64_C(0xea70909833de7193), U64_C(0x16849b86a12b9b01)}, {U64_C(0x21f3a6e0297ec143), U64_C(0x1203af9ee756159b)},
+    {U64_C(0x6985d7cd0f313537), U64_C(0x1cd2b297d889bc2b)}, {U64_C(0x2137dfd73f5a90f9), U64_C(0x170ef54646d49689)},
+    {U64_C(0xe75fe645cc4873fa), U64_C(0x12725dd1d243aba0)}, {U64_C(0xa5663d3c7a0d865d), U64_C(0x1d83c94fb6d2ac34)},
+    {U64_C(0x511e976394d79eb1), U64_C(0x179ca10c9242235d)}, {U64_C(0xda7edf82dd794bc1), U64_C(0x12e3b40a0e9b4f7d)},
+    {U64_C(0x2a6498d1625bac68), U64_C(0x1e392010175ee596)}, {U64_C(0xeeb6e0a781e2f053), U64_C(0x182db34012b25144)},
+    {U64_C(0x58924d52ce4f26a9), U64_C(0x1357c299a88ea76a)}, {U64_C(0x27507bb7b07ea441), U64_C(0x1ef2d0f5da7dd8aa)},
+    {U64_C(0x52a6c95fc0655034), U64_C(0x18c240c4aecb13bb)}, {U64_C(0x0eebd44c99eaa690), U64_C(0x13ce9a36f23c0fc9)},
+    {U64_C(0xb17953adc3110a80), U64_C(0x1fb0f6be50601941)}, {U64_C(0xc12ddc8b02740867), U64_C(0x195a5efea6b34767)},
+    {U64_C(0x3424b06f3529a052), U64_C(0x14484bfeebc29f86)}, {U64_C(0x901d59f290ee19db), U64_C(0x1039d66589687f9e)},
+    {U64_C(0x4cfbc31db4b0295f), U64_C(0x19f623d5a8a73297)}, {U64_C(0x3d9635b15d59bab2), U64_C(0x14c4e977ba1f5bac)},
+    {U64_C(0x97ab5e277de16228), U64_C(0x109d8792fb4c4956)}, {U64_C(0xf2abc9d8c9689d0d), U64_C(0x1a95a5b7f87a0ef0)},
+    {U64_C(0x5bbca17a3aba173e), U64_C(0x154484932d2e725a)}, {U64_C(0xafca1ac82efb45cb), U64_C(0x11039d428a8b8eae)},
+    {U64_C(0xb2dcf7a6b1920945), U64_C(0x1b38fb9daa78e44a)}, {U64_C(0xf57d92ebc141a104), U64_C(0x15c72fb1552d836e)},
+    {U64_C(0xc46475896767b403), U64_C(0x116c262777579c58)}, {U64_C(0x6d6d88dbd8a5ecd2), U64_C(0x1be03d0bf225c6f4)},
+    {U64_C(0x8abe071646eb23db), U64_C(0x164cfda3281e38c3)}, {U64_C(0x6efe6c11d255b649), U64_C(0x11d7314f534b609c)},
+    {U64_C(0xb197134fb6ef8a0e), U64_C(0x1c8b821885456760)}, {U64_C(0x27ac0f72f8bfa1a5), U64_C(0x16d601ad376ab91a)},
+    {U64_C(0xb95672c260994e1e), U64_C(0x1244ce242c5560e1)}, {U64_C(0xf5571e03cdc21695), U64_C(0x1d3ae36d13bbce35)},
+    {U64_C(0x2aac18030b01abab), U64_C(0x17624f8a762fd82b)}, {U64_C(0xbbbce0026f348956), U64_C(0x12b50c6ec4f31355)},
+    {U64_C(0x92c7ccd0b1eda889), U64_C(0x1dee7a4ad4b81eef)}, {U64_C(0xdbd30a408e57ba07), U64_C(0x17f1fb6f10934bf2)},
+    {U64_C(0x7ca8d50071dfc806), U64_C(0x1327fc58da0f6ff5)}, {U64_C(0xfaa7bb33e9660cd6), U64_C(0x1ea6608e29b24cbb)},
+    {U64_C(0x9552fc298784d711), U64_C(0x18851a0b548ea3c9)}, {U64_C(0xaaa8c9bad2d0ac0e), U64_C(0x139dae6f76d88307)},
+    {U64_C(0xdddadc5e1e1aace3), U64_C(0x1f62b0b257c0d1a5)}, {U64_C(0x7e48b04b4b488a4f), U64_C(0x191bc08eac9a4151)},
+    {U64_C(0xcb6d59d5d5d3a1d9), U64_C(0x141633a556e1cdda)}, {U64_C(0x3c577b1177dc817b), U64_C(0x1011c2eaabe7d7e2)},
+    {U64_C(0xc6f25e825960cf2a), U64_C(0x19b604aaaca62636)}, {U64_C(0x6bf518684780a5bb), U64_C(0x14919d5556eb51c5)},
+    {U64_C(0x232a79ed06008496), U64_C(0x10747ddddf22a7d1)}, {U64_C(0xd1dd8fe1a3340756), U64_C(0x1a53fc9631d10c81)},
+    {U64_C(0xa7e4731ae8f66c45), U64_C(0x150ffd44f4a73d34)}, {U64_C(0x531d28e253f8569e), U64_C(0x10d9976a5d52975d)},
+    {U64_C(0xeb61db03b98d5762), U64_C(0x1af5bf109550f22e)}, {U64_C(0xbc4e48cfc7a445e8), U64_C(0x159165a6ddda5b58)},
+    {U64_C(0x6371d3d96c836b20), U64_C(0x11411e1f17e1e2ad)}, {U64_C(0x9f1c8628ad9f11cd), U64_C(0x1b9b6364f3030448)},
+    {U64_C(0xe5b06b53be18db0b), U64_C(0x1615e91d8f359d06)}, {U64_C(0xeaf3890fcb4715a2), U64_C(0x11ab20e472914a6b)},
+    {U64_C(0x44b8db4c7871bc37), U64_C(0x1c45016d841baa46)}, {U64_C(0x03c715d6c6c1635f), U64_C(0x169d9abe03495505)},
+    {U64_C(0x3638de456bcde919), U64_C(0x1217aefe69077737)}, {U64_C(0x56c163a2461641c1), U64_C(0x1cf2b1970e725858)},
+    {U64_C(0xdf011c81d1ab67ce), U64_C(0x17288e1271f51379)}, {U64_C(0x7f3416ce4155eca5), U64_C(0x1286d80ec190dc61)},
+    {U64_C(0x6520247d3556476e), U64_C(0x1da48ce468e7c702)}, {U64_C(0xea801d30f7783925), U64_C(0x17b6d71d20b96c01)},
+    {U64_C(0xbb99b0f3f92cfa84), U64_C(0x12f8ac174d612334)}, {U64_C(0x5f5c4e532847f739), U64_C(0x1e5aacf215683854)},
+    {U64_C(0x7f7d0b75b9d32c2e), U64_C(0x18488a5b44536043)}, {U64_C(0x9930d5f7c7dc2358), U64_C(0x136d3b7c36a919cf)},
+    {U64_C(0x8eb4898c72f9d226), U64_C(0x1f152bf9f10e8fb2)}, {U64_C(0x722a07a38f2e41b8), U64_C(0x18ddbcc7f40ba628)},
+    {U64_C(0xc1bb394fa5be9afa), U64_C(0x13e497065cd61e86)}, {U64_C(0x9c5ec2190930f7f6), U64_C(0x1fd424d6faf030d7)},
+    {U64_C(0x49e56814075a5ff8), U64_C(0x197683df2f268d79)}, {U64_C(0x6e51201005e1e660), U64_C(0x145ecfe5bf520ac7)},
+    {U64_C(0xf1da800cd181851a), U64_C(0x104bd984990e6f05)}, {U64_C(0x4fc400148268d4f5), U64_C(0x1a12f5a0f4e3e4d6)},
+    {U64_C(0xd96999aa01ed772b), U64_C(0x14dbf7b3f71cb711)}, {U64_C(0xadee1488018ac5bc), U64_C(0x10aff95cc5b09274)},
+    {U64_C(0x497ceda668de092c), U64_C(0x1ab328946f80ea54)}, {U64_C(0x3aca57b853e4d424), U64_C(0x155c2076bf9a5510)},
+    {U64_C(0x623b7960431d7683), U64_C(0x1116805effaeaa73)}, {U64_C(0x9d2bf566d1c8bd9e), U64_C(0x1b5733cb32b110b8)},
+    {U64_C(0x7dbcc452416d647f), U64_C(0x15df5ca28ef40d60)}, {U64_C(0xcafd69db678ab6cc), U64_C(0x117f7d4ed8c33de6)},
+    {U64_C(0xab2f0fc572778adf), U64_C(0x1bff2ee48e052fd7)}, {U64_C(0x88f273045b92d580), U64_C(0x1665bf1d3e6a8cac)},
+    {U64_C(0xd3f528d049424466), U64_C(0x11eaff4a98553d56)}, {U64_C(0xb988414d4203a0a3), U64_C(0x1cab3210f3bb9557)},
+    {U64_C(0x6139cdd76802e6e9), U64_C(0x16ef5b40c2fc7779)}, {U64_C(0xe761717920025254), U64_C(0x125915cd68c9f92d)},
+    {U64_C(0xa568b58e999d5086), U64_C(0x1d5b561574765b7c)}, {U64_C(0x5120913ee14aa6d2), U64_C(0x177c44ddf6c515fd)},
+    {U64_C(0xa74d40ff1aa21f0e), U64_C(0x12c9d0b1923744ca)}, {U64_C(0x0baece64f769cb4a), U64_C(0x1e0fb44f50586e11)},
+    {U64_C(0x3c8bd850c5ee3c3b), U64_C(0x180c903f7379f1a7)}, {U64_C(0xca0979da37f1c9c9), U64_C(0x133d4032c2c7f485)},
+    {U64_C(0xa9a8c2f6bfe942db), U64_C(0x1ec866b79e0cba6f)}, {U64_C(0x2153cf2bccba9be3), U64_C(0x18a0522c7e709526)},
+    {U64_C(0x1aa9728970954982), U64_C(0x13b374f06526ddb8)}, {U64_C(0xf775840f1a88759d), U64_C(0x1f8587e7083e2f8c)},
+    {U64_C(0x5f9136727ba05e17), U64_C(0x19379fec0698260a)}, {U64_C(0x1940f85b9619e4df), U64_C(0x142c7ff0054684d5)},
+    {U64_C(0xe100c6afab47ea4c), U64_C(0x1023998cd1053710)}, {U64_C(0xce67a44c453fdd47), U64_C(0x19d28f47b4d524e7)},
+    {U64_C(0xd852e9d69dccb106), U64_C(0x14a8729fc3ddb71f)}, {U64_C(0x79dbee454b0a2738), U64_C(0x1086c219697e2c19)},
+    {U64_C(0x295fe3a211a9d859), U64_C(0x1a71368f0f30468f)}, {U64_C(0xbab31c81a7bb137a), U64_C(0x15275ed8d8f36ba5)},
+    {U64_C(0x6228e39aec95a92f), U64_C(0x10ec4be0ad8f8951)}, {U64_C(0x9d0e38f7e0ef7517), U64_C(0x1b13ac9aaf4c0ee8)},
+    {U64_C(0xb0d82d931a592a79), U64_C(0x15a956e225d67253)}, {U64_C(0x8d79be0f4847552e), U64_C(0x11544581b7dec1dc)},
+    {U64_C(0x158f967eda0bbb7c), U64_C(0x1bba08cf8c979c94)}, {U64_C(0x77a611ff14d62f97), U64_C(0x162e6d72d6dfb076)},
+    {U64_C(0xf951a7ff43de8c79), U64_C(0x11bebdf578b2f391)}, {U64_C(0xc21c3ffed2fdad8e), U64_C(0x1c6463225ab7ec1c)},
+    {U64_C(0x01b0333242648ad8), U64_C(0x16b6b5b5155ff017)}, {U64_C(0x0159c28e9b83a246), U64_C(0x122bc490dde659ac)},
+    {U64_C(0xcef604175f3903a3), U64_C(0x1d12d41afca3c2ac)}, {U64_C(0x725e69ac4c2d9c83), U64_C(0x17424348ca1c9bbd)},
+    {U64_C(0xf5185489d68ae39c), U64_C(0x129b69070816e2fd)}, {U64_C(0xee8d540fbdab05c6), U64_C(0x1dc574d80cf16b2f)},
+    {U64_C(0xbed77672fe226b05), U64_C(0x17d12a4670c1228c)}, {U64_C(0xff12c528cb4ebc04), U64_C(0x130dbb6b8d674ed6)},
+    {U64_C(0xcb513b74787df9a0), U64_C(0x1e7c5f127bd87e24)}, {U64_C(0x090dc929f9fe614d), U64_C(0x18637f41fcad31b7)},
+    {U64_C(0xa0d7d42194cb810a), U64_C(0x1382cc34ca2427c5)}, {U64_C(0x67bfb9cf5478ce77), U64_C(0x1f37ad21436d0c6f)},
+    {U64_C(0x1fcc94a5dd2d71f9), U64_C(0x18f9574dcf8a7059)}, {U64_C(0x7fd6dd517dbdf4c7), U64_C(0x13faac3e3fa1f37a)},
+    {U64_C(0xffbe2ee8c92fee0b), U64_C(0x1ff779fd329cb8c3)}, {U64_C(0x6631bf20a0f324d6), U64_C(0x1992c7fdc216fa36)},
+    {U64_C(0xb827cc1a1a5c1d78), U64_C(0x14756ccb01abfb5e)}, {U64_C(0x935309ae7b7ce460), U64_C(0x105df0a267bcc918)},
+    {U64_C(0x1eeb42b0c594a099), U64_C(0x1a2fe76a3f9474f4)}, {U64_C(0xe58902270476e6e1), U64_C(0x14f31f8832dd2a5c)},
+    {U64_C(0xb7a0ce859d2bebe7), U64_C(0x10c27fa028b0eeb0)}, {U64_C(0x59014a6f61dfdfd8), U64_C(0x1ad0cc33744e4ab4)},
+    {U64_C(0xe0cdd525e7e64cad), U64_C(0x1573d68f903ea229)}, {U64_C(0x4d7177518651d6f1), U64_C(0x11297872d9cbb4ee)},
+    {U64_C(0x7be8bee8d6e957e8), U64_C(0x1b758d848fac54b0)}, {U64_C(0xfcba3253df211320), U64_C(0x15f7a46a0c89dd59)},
+    {U64_C(0x63c8284318e74280), U64_C(0x1192e9ee706e4aae)}, {U64_C(0x060d0d3827d86a66), U64_C(0x1c1e43171a4a1117)},
+    {U64_C(0x6b3da42cecad21eb), U64_C(0x167e9c127b6e7412)}, {U64_C(0x88fe1cf0bd574e56), U64_C(0x11fee341fc585cdb)},
+    {U64_C(0x419694b462254a23), U64_C(0x1ccb0536608d615f)}, {U64_C(0x67abaa29e81dd4e9), U64_C(0x1708d0f84d3de77f)},
+    {U64_C(0xb95621bb2017dd87), U64_C(0x126d73f9d764b932)}, {U64_C(0xc223692b668c95a5), U64_C(0x1d7becc2f23ac1ea)},
+    {U64_C(0xce82ba891ed6de1d), U64_C(0x179657025b6234bb)}, {U64_C(0xa53562074bdf1818), U64_C(0x12deac01e2b4f6fc)},
+    {U64_C(0x3b889cd87964f359), U64_C(0x1e3113363787f194)}, {U64_C(0xfc6d4a46c783f5e1), U64_C(0x18274291c6065adc)},
+    {U64_C(0x30576e9f06032b1a), U64_C(0x13529ba7d19eaf17)}, {U64_C(0x1a257dcb3cd1de90), U64_C(0x1eea92a61c311825)},
+    {U64_C(0x481dfe3c30a7e540), U64_C(0x18bba884e35a79b7)}, {U64_C(0xd34b31c9c0865100), U64_C(0x13c9539d82aec7c5)},
+    {U64_C(0x5211e942cda3b4cd), U64_C(0x1fa885c8d117a609)}, {U64_C(0x74db21023e1c90a4), U64_C(0x19539e3a40dfb807)},
+    {U64_C(0xf715b401cb4a0d50), U64_C(0x1442e4fb67196005)}, {U64_C(0xf8de299b09080aa7), U64_C(0x103583fc527ab337)},
+    {U64_C(0x8e304291a80cddd7), U64_C(0x19ef3993b72ab859)}, {U64_C(0x3e8d020e200a4b13), U64_C(0x14bf6142f8eef9e1)},
+    {U64_C(0x653d9b3e80083c0f), U64_C(0x10991a9bfa58c7e7)}, {U64_C(0x6ec8f864000d2ce4), U64_C(0x1a8e90f9908e0ca5)},
+    {U64_C(0x8bd3f9e999a423ea), U64_C(0x153eda614071a3b7)}, {U64_C(0x3ca994bae1501cbb), U64_C(0x10ff151a99f482f9)},
+    {U64_C(0xc775bac49bb3612b), U64_C(0x1b31bb5dc320d18e)}, {U64_C(0xd2c4956a16291a89), U64_C(0x15c162b168e70e0b)},
+    {U64_C(0xdbd0778811ba7ba1), U64_C(0x11678227871f3e6f)}, {U64_C(0x2c80bf401c5d929b), U64_C(0x1bd8d03f3e9863e6)},
+    {U64_C(0xbd33cc3349e47549), U64_C(0x16470cff6546b651)}, {U64_C(0xca8fd68f6e505dd4), U64_C(0x11d270cc51055ea7)},
+    {U64_C(0x4419574be3b3c953), U64_C(0x1c83e7ad4e6efdd9)}, {U64_C(0x0347790982f63aa9), U64_C(0x16cfec8aa52597e1)},
+    {U64_C(0xcf6c60d468c4fbba), U64_C(0x123ff06eea847980)}, {U64_C(0xe57a34870e07f92a), U64_C(0x1d331a4b10d3f59a)},
+    {U64_C(0x512e906c0b399422), U64_C(0x175c1508da432ae2)}, {U64_C(0xda8ba6bcd5c7a9b5), U64_C(0x12b010d3e1cf5581)},
+    {U64_C(0x90df712e22d90f87), U64_C(0x1de6815302e5559c)}, {U64_C(0xda4c5a8b4f140c6c), U64_C(0x17eb9aa8cf1dde16)},
+    {U64_C(0xaea37ba2a5a9a38a), U64_C(0x1322e220a5b17e78)}, {U64_C(0x7dd25f6aa2a905a9), U64_C(0x1e9e369aa2b59727)},
+    {U64_C(0x97db7f888220d154), U64_C(0x187e92154ef7ac1f)}, {U64_C(0x797c6606ce80a777), U64_C(0x139874ddd8c6234c)},
+    {U64_C(0x8f2d700ae4010bf1), U64_C(0x1f5a549627a36bad)}, {U64_C(0x0c2459a25000d65a), U64_C(0x191510781fb5efbe)},
+    {U64_C(0x701d1481d99a4515), U64_C(0x1410d9f9b2f7f2fe)}, {U64_C(0xc017439b147b6a77), U64_C(0x100d7b2e28c65bfe)},
+    {U64_C(0xccf205c4ed9243f2), U64_C(0x19af2b7d0e0a2cca)}, {U64_C(0x0a5b37d0be0e9cc2), U64_C(0x148c22ca71a1bd6f)},
+    {U64_C(0x0848f973cb3ee3ce), U64_C(0x10701bd527b4978c)}, {U64_C(0xda0e5bec78649fb0), U64_C(0x1a4cf9550c5425ac)},
+    {U64_C(0x7b3eaff060507fc0), U64_C(0x150a6110d6a9b7bd)}, {U64_C(0x95cbbff380406633), U64_C(0x10d51a73deee2c97)},
+    {U64_C(0xefac665266cd7052), U64_C(0x1aee90b964b04758)}, {U64_C(0x2623850eb8a459db), U64_C(0x158ba6fab6f36c47)},
+    {U64_C(0x1e82d0d893b6ae49), U64_C(0x113c85955f29236c)}, {U64_C(0xfd9e1af41f8ab075), U64_C(0x1b9408eefea838ac)},
+    {U64_C(0x97b1af29b2d559f7), U64_C(0x16100725988693bd)}, {U64_C(0xac8e25baf5777b2c), U64_C(0x11a66c1e139edc97)},
+    {U64_C(0x7a7d092b2258c513), U64_C(0x1c3d79c9b8fe2dbf)}, {U64_C(0x61fda0ef4ead6a76), U64_C(0x169794a160cb57cc)},
+    {U64_C(0xe7fe1a590bbdeec5), U64_C(0x1212dd4de7091309)}, {U64_C(0xa6635d5b45fcb13a), U64_C(0x1ceafbafd80e84dc)},
+    {U64_C(0x851c4aaf6b308dc8), U64_C(0x172262f3133ed0b0)}, {U64_C(0xd0e36ef2bc26d7d4), U64_C(0x1281e8c275cbda26)},
+    {U64_C(0xb49f17eac6a48c86), U64_C(0x1d9ca79d894629d7)}, {U64_C(0x2a18dfef0550706b), U64_C(0x17b08617a104ee46)},
+    {U64_C(0x54e0b3259dd9f389), U64_C(0x12f39e794d9d8b6b)}, {U64_C(0x87cdeb6f62f65274), U64_C(0x1e5297287c2f4578)},
+    {U64_C(0xd30b22bf825ea85d), U64_C(0x18421286c9bf6ac6)}, {U64_C(0x0f3c1bcc684bb9e4), U64_C(0x13680ed23aff889f)},
+    {U64_C(0x18602c7a4079296d), U64_C(0x1f0ce4839198da98)}, {U64_C(0x46b356c833942124), U64_C(0x18d71d360e13e213)},
+    {U64_C(0x388f78a029434db6), U64_C(0x13df4a91a4dcb4dc)}, {U64_C(0x5a7f2766a86baf8a), U64_C(0x1fcbaa82a1612160)},
+    {U64_C(0x153285ebb9efbfa2), U64_C(0x196fbb9bb44db44d)}, {U64_C(0xaa8ed189618c994e), U64_C(0x145962e2f6a4903d)},
+    {U64_C(0xeed8a7a11ad6e10c), U64_C(0x1047824f2bb6d9ca)}, {U64_C(0x7e27729b5e249b45), U64_C(0x1a0c03b1df8af611)},
+    {U64_C(0xfe85f549181d4904), U64_C(0x14d6695b193bf80d)}, {U64_C(0xcb9e5dd4134aa0d0), U64_C(0x10ab877c142ff9a4)},
+    {U64_C(0xdf63c9535211014d), U64_C(0x1aac0bf9b9e65c3a)}, {U64_C(0x191ca10f74da6771), U64_C(0x15566ffafb1eb02f)},
+    {U64_C(0xadb080d92a4852c1), U64_C(0x1111f32f2f4bc025)}, {U64_C(0x15e7348eaa0d5134), U64_C(0x1b4feb7eb212cd09)},
+    {U64_C(0xab1f5d3eee710dc4), U64_C(0x15d98932280f0a6d)}, {U64_C(0xbc1917658b8da49d), U64_C(0x117ad428200c0857)},
+    {U64_C(0x2cf4f23c127c3a94), U64_C(0x1bf7b9d9cce00d59)}, {U64_C(0xf0c3f4fcdb969543), U64_C(0x165fc7e170b33de0)},
+    {U64_C(0x5a365d9716121103), U64_C(0x11e6398126f5cb1a)}, {U64_C(0x9056fc24f01ce804), U64_C(0x1ca38f350b22de90)},
+    {U64_C(0xd9df301d8ce3ecd0), U64_C(0x16e93f5da2824ba6)}, {U64_C(0xe17f59b13d8323da), U64_C(0x125432b14ecea2eb)},
+    {U64_C(0x68cbc2b52f38395c), U64_C(0x1d53844ee47dd179)}, {U64_C(0x53d6355dbf602de3), U64_C(0x177603725064a794)},
+    {U64_C(0xa9782ab165e68b1c), U64_C(0x12c4cf8ea6b6ec76)}, {U64_C(0x0f26aab56fd744fa), U64_C(0x1e07b27dd78b13f1)},
+    {U64_C(0x3f52222abfdf6a62), U64_C(0x18062864ac6f4327)}, {U64_C(0x65db4e88997f884e), U64_C(0x1338205089f29c1f)},
+    {U64_C(0x6fc54a7428cc0d4a), U64_C(0x1ec033b40fea9365)}, {U64_C(0x596aa1f68709a43b), U64_C(0x1899c2f673220f84)},
+    {U64_C(0xadeee7f86c07b696), U64_C(0x13ae3591f5b4d936)}, {U64_C(0x497e3ff3e00c5756), U64_C(0x1f7d228322baf524)},
+    {U64_C(0xd464fff64cd6ac45), U64_C(0x1930e868e89590e9)}, {U64_C(0x4383fff83d7889d1), U64_C(0x14272053ed4473ee)},
+    {U64_C(0xcf9cccc69793a174), U64_C(0x101f4d0ff1038ff1)}, {U64_C(0x7f6147a425b90252), U64_C(0x19cbae7fe805b31c)},
+    {U64_C(0xcc4dd2e9b7c7350f), U64_C(0x14a2f1ffecd15c16)}, {U64_C(0x3d0b0f215fd290d9), U64_C(0x10825b3323dab012)},
+    {U64_C(0x61ab4b689950e7c1), U64_C(0x1a6a2b85062ab350)}, {U64_C(0x4e22a2ba1440b967), U64_C(0x1521bc6a6b555c40)},
+    {U64_C(0x0b4ee894dd009453), U64_C(0x10e7c9eebc4449cd)}, {U64_C(0x1217da87c800ed51), U64_C(0x1b0c764ac6d3a948)},
+    {U64_C(0xdb46486ca000bdda), U64_C(0x15a391d56bdc876c)}, {U64_C(0x490506bd4ccd64af), U64_C(0x114fa7ddefe39f8a)},
+    {U64_C(0xa8080ac87ae23ab1), U64_C(0x1bb2a62fe638ff43)}, {U64_C(0x5339a239fbe82ef4), U64_C(0x162884f31e93ff69)},
+    {U64_C(0x75c7b4fb2fecf25d), U64_C(0x11ba03f5b20fff87)}, {U64_C(0x22d92191e647ea2e), U64_C(0x1c5cd322b67fff3f)},
+    {U64_C(0xb57a8141850654f2), U64_C(0x16b0a8e891ffff65)}, {U64_C(0xc4620101373843f5), U64_C(0x1226ed86db3332b7)},
+    {U64_C(0x3a366801f1f39fee), U64_C(0x1d0b15a491eb8459)}, {U64_C(0xfb5eb99b27f6198b), U64_C(0x173c115074bc69e0)},
+    {U64_C(0x2f7efae2865e7ad6), U64_C(0x129674405d6387e7)}, {U64_C(0xe597f7d0d6fd9156), U64_C(0x1dbd86cd6238d971)},
+    {U64_C(0x8479930d78cadaab), U64_C(0x17cad23de82d7ac1)}, {U64_C(0xd06142712d6f1556), U64_C(0x1308a831868ac89a)},
+    {U64_C(0x4d686a4eaf182222), U64_C(0x1e74404f3daada91)}, {U64_C(0xa453883ef279b4e8), U64_C(0x185d003f6488aeda)},
+    {U64_C(0xe9dc6cff28615d87), U64_C(0x137d99cc506d58ae)}, {U64_C(0xa960ae650d6895a4), U64_C(0x1f2f5c7a1a488de4)},
+    {U64_C(0xbab3beb73ded4483), U64_C(0x18f2b061aea07183)}, {U64_C(0x2ef6322c318a9d36), U64_C(0x13f559e7bee6c136)},
+    {U64_C(0xe4bd1d13827761f0), U64_C(0x1feef63f97d79b89)}, {U64_C(0x83ca7da9352c4e5a), U64_C(0x198bf832dfdfafa1)},
+    {U64_C(0x9ca1fe20f756a515), U64_C(0x146ff9c24cb2f2e7)}, {U64_C(0x4a1b31b3f9121daa), U64_C(0x1059949b708f28b9)},
+    {U64_C(0x435eb5ecc1b695dd), U64_C(0x1a28edc580e50df5)}, {U64_C(0x35e55e57015ede4a), U64_C(0x14ed8b04671da4c4)},
+    {U64_C(0xc4b77eac0118b1d5), U64_C(0x10be08d0527e1d69)}, {U64_C(0xa12597799b5ab622), U64_C(0x1ac9a7b3b7302f0f)},
+    {U64_C(0x4db7ac6149155e81), U64_C(0x156e1fc2f8f358d9)}, {U64_C(0xd7c6238107444b9b), U64_C(0x1124e63593f5e0ad)},
+    {U64_C(0x593d059b3ed3ac2b), U64_C(0x1b6e3d2286563449)}, {U64_C(0xe0fd9e15cbdc89bc), U64_C(0x15f1ca820511c36d)},
+    {U64_C(0xb3fe18116fe3a163), U64_C(0x118e3b9b37416924)}, {U64_C(0x866359b57fd29bd1), U64_C(0x1c16c5c525357507)},
+    {U64_C(0xd1e91491330ee30e), U64_C(0x16789e3750f790d2)}, {U64_C(0x74ba76da8f3f1c0b), U64_C(0x11fa182c40c60d75)},
+    {U64_C(0xedf72490e531c678), U64_C(0x1cc359e067a348bb)}, {U64_C(0x8b2c1d40b75b052d), U64_C(0x1702ae4d1fb5d3c9)},
+    {U64_C(0x6f567dcd5f7c0424), U64_C(0x12688b70e62b0fd4)}, {U64_C(0x7ef0c94898c66d06), U64_C(0x1d74124e3d11b2ed)},
+    {U64_C(0x98c0a106e09ebd9f), U64_C(0x17900ea4fda7c257)}, {U64_C(0x470080d24d4bcae6), U64_C(0x12d9a550caec9b79)},
+    {U64_C(0xd800ce1d487944a2), U64_C(0x1e29088144adc58e)}, {U64_C(0x1333d8176d2dd082), U64_C(0x1820d39a9d57d13f)},
+    {U64_C(0xa8f646792424a6ce), U64_C(0x134d76154aaca765)}, {U64_C(0x74bd3d8ea03aa47d), U64_C(0x1ee25688777aa56f)},
+    {U64_C(0x5d64313ee6955064), U64_C(0x18b51206c5fbb78c)}, {U64_C(0x4ab68dcbebaaa6b7), U64_C(0x13c40e6bd1962c70)},
+    {U64_C(0x1124161312aaa457), U64_C(0x1fa01712e8f0471a)}, {U64_C(0xda8344dc0eeee9df), U64_C(0x194cdf4253f36c14)},
+    {U64_C(0xe2029d7cd8bf2180), U64_C(0x143d7f6843292343)}, {U64_C(0x4e687dfd7a328133), U64_C(0x103132b9cf541c36)},
+    {U64_C(0x4a40c9959050ceb8), U64_C(0x19e851294bb9c6bd)}, {U64_C(0x0833d477a6a70bc6), U64_C(0x14b9da876fc7d231)},
+    {U64_C(0xa02976c61eec096b), U64_C(0x1094aed2bfd30e8d)}, {U64_C(0x004257a364acdbdf), U64_C(0x1a877e1dffb81749)},
+    {U64_C(0xcd01dfb5ea23e319), U64_C(0x153931b1996012a0)}, {U64_C(0x70ce4c91881cb5ae), U64_C(0x10fa8e27ade6754d)},
+    {U64_C(0x1ae3adb5a69455e2), U64_C(0x1b2a7d0c4970bbaf)}, {U64_C(0x7be957c4854377e8), U64_C(0x15bb973d078d62f2)},
+    {U64_C(0xc987796a0435f987), U64_C(0x1162df64060ab58e)}, {U64_C(0x75a58f1006bcc271), U64_C(0x1bd1656cd67788e4)},
+    {U64_C(0xf7b7a5a66bca3527), U64_C(0x16411df0ab92d3e9)}, {U64_C(0x5fc61e1ebca1c41f), U64_C(0x11cdb18d560f0fee)},
+    {U64_C(0xffa363646102d365), U64_C(0x1c7c4f4889b1b316)}, {U64_C(0x32e91c504d9bdc51), U64_C(0x16c9d906d48e28df)},
+    {U64_C(0x8f20e37371497d0e), U64_C(0x123b140576d820b2)}, {U64_C(0x7e9b0585820f2e7c), U64_C(0x1d2b533bf159cdea)},
+    {U64_C(0xcbaf379e01a5beca), U64_C(0x1755dc2ff447d7ee)}, {U64_C(0x0958f94b348498a1), U64_C(0x12ab168cc36cacbf)},
+};
+
+// top 125 bits of 5^i, low 64 bits first
+SYM_WEAK const u64 Format__pow5_split[326][2] = {
+    {U64_C(0x0000000000000000), U64_C(0x1000000000000000)}, {U64_C(0x0000000000000000), U64_C(0x1400000000000000)},
+    {U64_C(0x0000000000000000), U64_C(0x1900000000000000)}, {U64_C(0x0000000000000000), U64_C(0x1f40000000000000)},
+    {U64_C(0x0000000000000000), U64_C(0x1388000000000000)}, {U64_C(0x0000000000000000), U64_C(0x186a000000000000)},
+    {U64_C(0x0000000000000000), U64_C(0x1e84800000000000)}, {U64_C(0x0000000000000000), U64_C(0x1312d00000000000)},
+    {U64_C(0x0000000000000000), U64_C(0x17d7840000000000)}, {U64_C(0x0000000000000000), U64_C(0x1dcd650000000000)},
+    {U64_C(0x0000000000000000), U64_C(0x12a05f2000000000)}, {U64_C(0x0000000000000000), U64_C(0x174876e800000000)},
+    {U64_C(0x0000000000000000), U64_C(0x1d1a94a200000000)}, {U64_C(0x0000000000000000), U64_C(0x12309ce540000000)},
+    {U64_C(0x0000000000000000), U64_C(0x16bcc41e90000000)}, {U64_C(0x0000000000000000), U64_C(0x1c6bf52634000000)},
+    {U64_C(0x0000000000000000), U64_C(0x11c37937e0800000)}, {U64_C(0x0000000000000000), U64_C(0x16345785d8a00000)},
+    {U64_C(0x0000000000000000), U64_C(0x1bc16d674ec80000)}, {U64_C(0x0000000000000000), U64_C(0x1158e460913d0000)},
+    {U64_C(0x0000000000000000), U64_C(0x15af1d78b58c4000)}, {U64_C(0x0000000000000000), U64_C(0x1b1ae4d6e2ef5000)},
+    {U64_C(0x0000000000000000), U64_C(0x10f0cf064dd59200)}, {U64_C(0x0000000000000000), U64_C(0x152d02c7e14af680)},
+    {U64_C(0x0000000000000000), U64_C(0x1a784379d99db420)}, {U64_C(0x0000000000000000), U64_C(0x108b2a2c28029094)},
+    {U64_C(0x0000000000000000), U64_C(0x14adf4b7320334b9)}, {U64_C(0x4000000000000000), U64_C(0x19d971e4fe8401e7)},
+    {U64_C(0x8800000000000000), U64_C(0x1027e72f1f128130)}, {U64_C(0xaa00000000000000), U64_C(0x1431e0fae6d7217c)},
+    {U64_C(0xd480000000000000), U64_C(0x193e5939a08ce9db)}, {U64_C(0xc9a0000000000000), U64_C(0x1f8def8808b02452)},
+    {U64_C(0xbe04000000000000), U64_C(0x13b8b5b5056e16b3)}, {U64_C(0xad85000000000000), U64_C(0x18a6e32246c99c60)},
+    {U64_C(0xd8e6400000000000), U64_C(0x1ed09bead87c0378)}, {U64_C(0x878fe80000000000), U64_C(0x13426172c74d822b)},
+    {U64_C(0x6973e20000000000), U64_C(0x1812f9cf7920e2b6)}, {U64_C(0x03d0da8000000000), U64_C(0x1e17b84357691b64)},
+    {U64_C(0x8262889000000000), U64_C(0x12ced32a16a1b11e)}, {U64_C(0x22fb2ab400000000), U64_C(0x178287f49c4a1d66)},
+    {U64_C(0xabb9f56100000000), U64_C(0x1d6329f1c35ca4bf)}, {U64_C(0xcb54395ca0000000), U64_C(0x125dfa371a19e6f7)},
+    {U64_C(0xbe2947b3c8000000), U64_C(0x16f578c4e0a060b5)}, {U64_C(0x2db399a0ba000000), U64_C(0x1cb2d6f618c878e3)},
+    {U64_C(0xfc90400474400000), U64_C(0x11efc659cf7d4b8d)}, {U64_C(0x7bb4500591500000), U64_C(0x166bb7f0435c9e71)},
+    {U64_C(0xdaa16406f5a40000), U64_C(0x1c06a5ec5433c60d)}, {U64_C(0xa8a4de8459868000), U64_C(0x118427b3b4a05bc8)},
+    {U64_C(0xd2ce16256fe82000), U64_C(0x15e531a0a1c872ba)}, {U64_C(0x87819baecbe22800), U64_C(0x1b5e7e08ca3a8f69)},
+    {U64_C(0xf4b1014d3f6d5900), U64_C(0x111b0ec57e6499a1)}, {U64_C(0x71dd41a08f48af40), U64_C(0x1561d276ddfdc00a)},
+    {U64_C(0x0e549208b31adb10), U64_C(0x1aba4714957d300d)}, {U64_C(0x28f4db456ff0c8ea), U64_C(0x10b46c6cdd6e3e08)},
+    {U64_C(0x33321216cbecfb24), U64_C(0x14e1878814c9cd8a)}, {U64_C(0xbffe969c7ee839ed), U64_C(0x1a19e96a19fc40ec)},
+    {U64_C(0xf7ff1e21cf512434), U64_C(0x105031e2503da893)}, {U64_C(0xf5fee5aa43256d41), U64_C(0x14643e5ae44d12b8)},
+    {U64_C(0x337e9f14d3eec892), U64_C(0x197d4df19d605767)}, {U64_C(0x005e46da08ea7ab6), U64_C(0x1fdca16e04b86d41)},
+    {U64_C(0xa03aec4845928cb2), U64_C(0x13e9e4e4c2f34448)}, {U64_C(0xc849a75a56f72fde), U64_C(0x18e45e1df3b0155a)},
+    {U64_C(0x7a5c1130ecb4fbd6), U64_C(0x1f1d75a5709c1ab1)}, {U64_C(0xec798abe93f11d65), U64_C(0x13726987666190ae)},
+    {U64_C(0xa797ed6e38ed64bf), U64_C(0x184f03e93ff9f4da)}, {U64_C(0x517de8c9c728bdef), U64_C(0x1e62c4e38ff87211)},
+    {U64_C(0xd2eeb17e1c7976b5), U64_C(0x12fdbb0e39fb474a)}, {U64_C(0x87aa5ddda397d462), U64_C(0x17bd29d1c87a191d)},
+    {U64_C(0xe994f5550c7dc97b), U64_C(0x1dac74463a989f64)}, {U64_C(0x11fd195527ce9ded), U64_C(0x128bc8abe49f639f)},
+    {U64_C(0xd67c5faa71c24568), U64_C(0x172ebad6ddc73c86)}, {U64_C(0x8c1b77950e32d6c2), U64_C(0x1cfa698c95390ba8)},
+    {U64_C(0x57912abd28dfc639), U64_C(0x121c81f7dd43a749)}, {U64_C(0xad75756c7317b7c8), U64_C(0x16a3a275d494911b)},
+    {U64_C(0x98d2d2c78fdda5ba), U64_C(0x1c4c8b1349b9b562)}, {U64_C(0x9f83c3bcb9ea8794), U64_C(0x11afd6ec0e14115d)},
+    {U64_C(0x0764b4abe8652979), U64_C(0x161bcca7119915b5)}, {U64_C(0x493de1d6e27e73d7), U64_C(0x1ba2bfd0d5ff5b22)},
+    {U64_C(0x6dc6ad264d8f0866), U64_C(0x1145b7e285bf98f5)}, {U64_C(0xc938586fe0f2ca80), U64_C(0x159725db272f7f32)},
+    {U64_C(0x7b866e8bd92f7d20), U64_C(0x1afcef51f0fb5eff)}, {U64_C(0xad34051767bdae34), U64_C(0x10de1593369d1b5f)},
+    {U64_C(0x9881065d41ad19c1), U64_C(0x15159af804446237)}, {U64_C(0x7ea147f492186032), U64_C(0x1a5b01b605557ac5)},
+    {U64_C(0x6f24ccf8db4f3c1f), U64_C(0x1078e111c3556cbb)}, {U64_C(0x4aee003712230b27), U64_C(0x14971956342ac7ea)},
+    {U64_C(0xdda98044d6abcdf0), U64_C(0x19bcdfabc13579e4)}, {U64_C(0x0a89f02b062b60b6), U64_C(0x10160bcb58c16c2f)},
+    {U64_C(0xcd2c6c35c7b638e4), U64_C(0x141b8ebe2ef1c73a)}, {U64_C(0x8077874339a3c71d), U64_C(0x1922726dbaae3909)},
+    {U64_C(0xe0956914080cb8e4), U64_C(0x1f6b0f092959c74b)}, {U64_C(0x6c5d61ac8507f38e), U64_C(0x13a2e965b9d81c8f)},
+    {U64_C(0x4774ba17a649f072), U64_C(0x188ba3bf284e23b3)}, {U64_C(0x1951e89d8fdc6c8f), U64_C(0x1eae8caef261aca0)},
+    {U64_C(0x0fd3316279e9c3d9), U64_C(0x132d17ed577d0be4)}, {U64_C(0x13c7fdbb186434cf), U64_C(0x17f85de8ad5c4edd)},
+    {U64_C(0x58b9fd29de7d4203), U64_C(0x1df67562d8b36294)}, {U64_C(0xb7743e3a2b0e4942), U64_C(0x12ba095dc7701d9c)},
+    {U64_C(0xe5514dc8b5d1db92), U64_C(0x17688bb5394c2503)}, {U64_C(0xdea5a13ae3465277), U64_C(0x1d42aea2879f2e44)},
+    {U64_C(0x0b2784c4ce0bf38a), U64_C(0x1249ad2594c37ceb)}, {U64_C(0xcdf165f6018ef06d), U64_C(0x16dc186ef9f45c25)},
+    {U64_C(0x416dbf7381f2ac88), U64_C(0x1c931e8ab871732f)}, {U64_C(0x88e497a83137abd5), U64_C(0x11dbf316b346e7fd)},
+    {U64_C(0xeb1dbd923d8596ca), U64_C(0x1652efdc6018a1fc)}, {U64_C(0x25e52cf6cce6fc7d), U64_C(0x1be7abd3781eca7c)},
+    {U64_C(0x97af3c1a40105dce), U64_C(0x1170cb642b133e8d)}, {U64_C(0xfd9b0b20d0147542), U64_C(0x15ccfe3d35d80e30)},
+    {U64_C(0x3d01cde904199292), U64_C(0x1b403dcc834e11bd)}, {U64_C(0x462120b1a28ffb9b), U64_C(0x1108269fd210cb16)},
+    {U64_C(0xd7a968de0b33fa82), U64_C(0x154a3047c694fddb)}, {U64_C(0xcd93c3158e00f923), U64_C(0x1a9cbc59b83a3d52)},
+    {U64_C(0xc07c59ed78c09bb6), U64_C(0x10a1f5b813246653)}, {U64_C(0xb09b7068d6f0c2a3), U64_C(0x14ca732617ed7fe8)},
+    {U64_C(0xdcc24c830cacf34c), U64_C(0x19fd0fef9de8dfe2)}, {U64_C(0xc9f96fd1e7ec180f), U64_C(0x103e29f5c2b18bed)},
+    {U64_C(0x3c77cbc661e71e13), U64_C(0x144db473335deee9)}, {U64_C(0x8b95beb7fa60e598), U64_C(0x1961219000356aa3)},
+    {U64_C(0x6e7b2e65f8f91efe), U64_C(0x1fb969f40042c54c)}, {U64_C(0xc50cfcffbb9bb35f), U64_C(0x13d3e2388029bb4f)},
+    {U64_C(0xb6503c3faa82a037), U64_C(0x18c8dac6a0342a23)}, {U64_C(0xa3e44b4f95234844), U64_C(0x1efb1178484134ac)},
+    {U64_C(0xe66eaf11bd360d2b), U64_C(0x135ceaeb2d28c0eb)}, {U64_C(0xe00a5ad62c839075), U64_C(0x183425a5f872f126)},
+    {U64_C(0x980cf18bb7a47493), U64_C(0x1e412f0f768fad70)}, {U64_C(0x5f0816f752c6c8dc), U64_C(0x12e8bd69aa19cc66)},
+    {U64_C(0xf6ca1cb527787b13), U64_C(0x17a2ecc414a03f7f)}, {U64_C(0xf47ca3e2715699d7), U64_C(0x1d8ba7f519c84f5f)},
+    {U64_C(0xf8cde66d86d62026), U64_C(0x127748f9301d319b)}, {U64_C(0xf7016008e88ba830), U64_C(0x17151b377c247e02)},
+    {U64_C(0xb4c1b80b22ae923c), U64_C(0x1cda62055b2d9d83)}, {U64_C(0x50f91306f5ad1b65), U64_C(0x12087d4358fc8272)},
+    {U64_C(0xe53757c8b318623f), U64_C(0x168a9c942f3ba30e)}, {U64_C(0x9e852dbadfde7acf), U64_C(0x1c2d43b93b0a8bd2)},
+    {U64_C(0xa3133c94cbeb0cc1), U64_C(0x119c4a53c4e69763)}, {U64_C(0x8bd80bb9fee5cff1), U64_C(0x16035ce8b6203d3c)},
+    {U64_C(0xaece0ea87e9f43ee), U64_C(0x1b843422e3a84c8b)}, {U64_C(0x4d40c9294f238a75), U64_C(0x1132a095ce492fd7)},
+    {U64_C(0x2090fb73a2ec6d12), U64_C(0x157f48bb41db7bcd)}, {U64_C(0x68b53a508ba78856), U64_C(0x1adf1aea12525ac0)},
+    {U64_C(0x417144725748b536), U64_C(0x10cb70d24b7378b8)}, {U64_C(0x51cd958eed1ae283), U64_C(0x14fe4d06de5056e6)},
+    {U64_C(0xe640faf2a8619b24), U64_C(0x1a3de04895e46c9f)}, {U64_C(0xefe89cd7a93d00f7), U64_C(0x1066ac2d5daec3e3)},
+    {U64_C(0xebe2c40d938c4134), U64_C(0x14805738b51a74dc)}, {U64_C(0x26db7510f86f5181), U64_C(0x19a06d06e2611214)},
+    {U64_C(0x9849292a9b4592f1), U64_C(0x100444244d7cab4c)}, {U64_C(0xbe5b73754216f7ad), U64_C(0x1405552d60dbd61f)},
+    {U64_C(0xadf25052929cb598), U64_C(0x1906aa78b912cba7)}, {U64_C(0x996ee4673743e2ff), U64_C(0x1f485516e7577e91)},
+    {U64_C(0xffe54ec0828a6ddf), U64_C(0x138d352e5096af1a)}, {U64_C(0xbfdea270a32d0957), U64_C(0x18708279e4bc5ae1)},
+    {U64_C(0x2fd64b0ccbf84bad), U64_C(0x1e8ca3185deb719a)}, {U64_C(0x5de5eee7ff7b2f4c), U64_C(0x1317e5ef3ab32700)},
+    {U64_C(0x755f6aa1ff59fb1f), U64_C(0x17dddf6b095ff0c0)}, {U64_C(0x92b7454a7f3079e7), U64_C(0x1dd55745cbb7ecf0)},
+    {U64_C(0x5bb28b4e8f7e4c30), U64_C(0x12a5568b9f52f416)}, {U64_C(0xf29f2e22335ddf3c), U64_C(0x174eac2e8727b11b)},
+    {U64_C(0xef46f9aac035570b), U64_C(0x1d22573a28f19d62)}, {U64_C(0xd58c5c0ab8215667), U64_C(0x123576845997025d)},
+    {U64_C(0x4aef730d6629ac01), U64_C(0x16c2d4256ffcc2f5)}, {U64_C(0x9dab4fd0bfb41701), U64_C(0x1c73892ecbfbf3b2)},
+    {U64_C(0xa28b11e277d08e60), U64_C(0x11c835bd3f7d784f)}, {U64_C(0x8b2dd65b15c4b1f9), U64_C(0x163a432c8f5cd663)},
+    {U64_C(0x6df94bf1db35de77), U64_C(0x1bc8d3f7b3340bfc)}, {U64_C(0xc4bbcf772901ab0a), U64_C(0x115d847ad000877d)},
+    {U64_C(0x35eac354f34215cd), U64_C(0x15b4e5998400a95d)}, {U64_C(0x8365742a30129b40), U64_C(0x1b221effe500d3b4)},
+    {U64_C(0xd21f689a5e0ba108), U64_C(0x10f5535fef208450)}, {U64_C(0x06a742c0f58e894a), U64_C(0x1532a837eae8a565)},
+    {U64_C(0x4851137132f22b9d), U64_C(0x1a7f5245e5a2cebe)}, {U64_C(0xed32ac26bfd75b42), U64_C(0x108f936baf85c136)},
+    {U64_C(0xa87f57306fcd3212), U64_C(0x14b378469b673184)}, {U64_C(0xd29f2cfc8bc07e97), U64_C(0x19e056584240fde5)},
+    {U64_C(0xa3a37c1dd7584f1e), U64_C(0x102c35f729689eaf)}, {U64_C(0x8c8c5b254d2e62e6), U64_C(0x14374374f3c2c65b)},
+    {U64_C(0x6faf71eea079fb9f), U64_C(0x1945145230b377f2)}, {U64_C(0x0b9b4e6a48987a87), U64_C(0x1f965966bce055ef)},
+    {U64_C(0x674111026d5f4c94), U64_C(0x13bdf7e0360c35b5)}, {U64_C(0xc111554308b71fba), U64_C(0x18ad75d8438f4322)},
+    {U64_C(0x7155aa93cae4e7a8), U64_C(0x1ed8d34e547313eb)}, {U64_C(0x26d58a9c5ecf10c9), U64_C(0x13478410f4c7ec73)},
+    {U64_C(0xf08aed437682d4fb), U64_C(0x1819651531f9e78f)}, {U64_C(0xecada89454238a3a), U64_C(0x1e1fbe5a7e786173)},
+    {U64_C(0x73ec895cb4963664), U64_C(0x12d3d6f88f0b3ce8)}, {U64_C(0x90e7abb3e1bbc3fd), U64_C(0x1788ccb6b2ce0c22)},
+    {U64_C(0x352196a0da2ab4fd), U64_C(0x1d6affe45f818f2b)}, {U64_C(0x0134fe24885ab11e), U64_C(0x1262dfeebbb0f97b)},
+    {U64_C(0xc1823dadaa715d65), U64_C(0x16fb97ea6a9d37d9)}, {U64_C(0x31e2cd19150db4bf), U64_C(0x1cba7de5054485d0)},
+    {U64_C(0x1f2dc02fad2890f7), U64_C(0x11f48eaf234ad3a2)}, {U64_C(0xa6f9303b9872b535), U64_C(0x1671b25aec1d888a)},
+    {U64_C(0x50b77c4a7e8f6282), U64_C(0x1c0e1ef1a724eaad)}, {U64_C(0x5272adae8f199d91), U64_C(0x1188d357087712ac)},
+    {U64_C(0x670f591a32e004f6), U64_C(0x15eb082cca94d757)}, {U64_C(0x40d32f60bf980633), U64_C(0x1b65ca37fd3a0d2d)},
+    {U64_C(0x4883fd9c77bf03e0), U64_C(0x111f9e62fe44483c)}, {U64_C(0x5aa4fd0395aec4d8), U64_C(0x156785fbbdd55a4b)},
+    {U64_C(0x314e3c447b1a760e), U64_C(0x1ac1677aad4ab0de)}, {U64_C(0xded0e5aaccf089c9), U64_C(0x10b8e0acac4eae8a)},
+    {U64_C(0x96851f15802cac3b), U64_C(0x14e718d7d7625a2d)}, {U64_C(0xfc2666dae037d74a), U64_C(0x1a20df0dcd3af0b8)},
+    {U64_C(0x9d980048cc22e68e), U64_C(0x10548b68a044d673)}, {U64_C(0x84fe005aff2ba032), U64_C(0x1469ae42c8560c10)},
+    {U64_C(0xa63d8071bef6883e), U64_C(0x198419d37a6b8f14)}, {U64_C(0xcfcce08e2eb42a4e), U64_C(0x1fe52048590672d9)},
+    {U64_C(0x21e00c58dd309a70), U64_C(0x13ef342d37a407c8)}, {U64_C(0x2a580f6f147cc10d), U64_C(0x18eb0138858d09ba)},
+    {U64_C(0xb4ee134ad99bf150), U64_C(0x1f25c186a6f04c28)}, {U64_C(0x7114cc0ec80176d2), U64_C(0x137798f428562f99)},
+    {U64_C(0xcd59ff127a01d486), U64_C(0x18557f31326bbb7f)}, {U64_C(0xc0b07ed7188249a8), U64_C(0x1e6adefd7f06aa5f)},
+    {U64_C(0xd86e4f466f516e09), U64_C(0x1302cb5e6f642a7b)}, {U64_C(0xce89e3180b25c98b), U64_C(0x17c37e360b3d351a)},
+    {U64_C(0x822c5bde0def3bee), U64_C(0x1db45dc38e0c8261)}, {U64_C(0xf15bb96ac8b58575), U64_C(0x1290ba9a38c7d17c)},
+    {U64_C(0x2db2a7c57ae2e6d2), U64_C(0x1734e940c6f9c5dc)}, {U64_C(0x391f51b6d99ba086), U64_C(0x1d022390f8b83753)},
+    {U64_C(0x03b3931248014454), U64_C(0x1221563a9b732294)}, {U64_C(0x04a077d6da019569), U64_C(0x16a9abc9424feb39)},
+    {U64_C(0x45c895cc9081fac3), U64_C(0x1c5416bb92e3e607)}, {U64_C(0x8b9d5d9fda513cba), U64_C(0x11b48e353bce6fc4)},
+    {U64_C(0xae84b507d0e58be8), U64_C(0x1621b1c28ac20bb5)}, {U64_C(0x1a25e249c51eeee3), U64_C(0x1baa1e332d728ea3)},
+    {U64_C(0xf057ad6e1b33554d), U64_C(0x114a52dffc679925)}, {U64_C(0x6c6d98c9a2002aa1), U64_C(0x159ce797fb817f6f)},
+    {U64_C(0x4788fefc0a803549), U64_C(0x1b04217dfa61df4b)}, {U64_C(0x0cb59f5d8690214e), U64_C(0x10e294eebc7d2b8f)},
+    {U64_C(0xcfe30734e83429a1), U64_C(0x151b3a2a6b9c7672)}, {U64_C(0x83dbc9022241340a), U64_C(0x1a6208b50683940f)},
+    {U64_C(0xb2695da15568c086), U64_C(0x107d457124123c89)}, {U64_C(0x1f03b509aac2f0a7), U64_C(0x149c96cd6d16cbac)},
+    {U64_C(0x26c4a24c1573acd1), U64_C(0x19c3bc80c85c7e97)}, {U64_C(0x783ae56f8d684c03), U64_C(0x101a55d07d39cf1e)},
+    {U64_C(0x16499ecb70c25f03), U64_C(0x1420eb449c8842e6)}, {U64_C(0x9bdc067e4cf2f6c4), U64_C(0x19292615c3aa539f)},
+    {U64_C(0x82d3081de02fb476), U64_C(0x1f736f9b3494e887)}, {U64_C(0xb1c3e512ac1dd0c9), U64_C(0x13a825c100dd1154)},
+    {U64_C(0xde34de57572544fc), U64_C(0x18922f31411455a9)}, {U64_C(0x55c215ed2cee963b), U64_C(0x1eb6bafd91596b14)},
+    {U64_C(0xb5994db43c151de5), U64_C(0x133234de7ad7e2ec)}, {U64_C(0xe2ffa1214b1a655e), U64_C(0x17fec216198ddba7)},
+    {U64_C(0xdbbf89699de0feb6), U64_C(0x1dfe729b9ff15291)}, {U64_C(0x2957b5e202ac9f31), U64_C(0x12bf07a143f6d39b)},
+    {U64_C(0xf3ada35a8357c6fe), U64_C(0x176ec98994f48881)}, {U64_C(0x70990c31242db8bd), U64_C(0x1d4a7bebfa31aaa2)},
+    {U64_C(0x865fa79eb69c9376), U64_C(0x124e8d737c5f0aa5)}, {U64_C(0xe7f791866443b854), U64_C(0x16e230d05b76cd4e)},
+    {U64_C(0xa1f575e7fd54a669), U64_C(0x1c9abd04725480a2)}, {U64_C(0xa53969b0fe54e801), U64_C(0x11e0b622c774d065)},
+    {U64_C(0x0e87c41d3dea2202), U64_C(0x1658e3ab7952047f)}, {U64_C(0xd229b5248d64aa82), U64_C(0x1bef1c9657a6859e)},
+    {U64_C(0x435a1136d85eea91), U64_C(0x117571ddf6c81383)}, {U64_C(0x143095848e76a536), U64_C(0x15d2ce55747a1864)},
+    {U64_C(0x193cbae5b2144e83), U64_C(0x1b4781ead1989e7d)}, {U64_C(0x2fc5f4cf8f4cb112), U64_C(0x110cb132c2ff630e)},
+    {U64_C(0xbbb77203731fdd56), U64_C(0x154fdd7f73bf3bd1)}, {U64_C(0x2aa54e844fe7d4ac), U64_C(0x1aa3d4df50af0ac6)},
+    {U64_C(0xdaa75112b1f0e4eb), U64_C(0x10a6650b926d66bb)}, {U64_C(0xd15125575e6d1e26), U64_C(0x14cffe4e7708c06a)},
+    {U64_C(0x85a56ead360865b0), U64_C(0x1a03fde214caf085)}, {U64_C(0x7387652c41c53f8e), U64_C(0x10427ead4cfed653)},
+    {U64_C(0x50693e7752368f71), U64_C(0x14531e58a03e8be8)}, {U64_C(0x64838e1526c4334e), U64_C(0x1967e5eec84e2ee2)},
+    {U64_C(0xfda4719a70754022), U64_C(0x1fc1df6a7a61ba9a)}, {U64_C(0xde86c70086494815), U64_C(0x13d92ba28c7d14a0)},
+    {U64_C(0x162878c0a7db9a1a), U64_C(0x18cf768b2f9c59c9)}, {U64_C(0x5bb296f0d1d280a1), U64_C(0x1f03542dfb83703b)},
+    {U64_C(0x194f9e5683239064), U64_C(0x1362149cbd322625)}, {U64_C(0x5fa385ec23ec747e), U64_C(0x183a99c3ec7eafae)},
+    {U64_C(0xf78c67672ce7919d), U64_C(0x1e494034e79e5b99)}, {U64_C(0x3ab7c0a07c10bb02), U64_C(0x12edc82110c2f940)},
+    {U64_C(0x4965b0c89b14e9c3), U64_C(0x17a93a2954f3b790)}, {U64_C(0x5bbf1cfac1da2433), U64_C(0x1d9388b3aa30a574)},
+    {U64_C(0xb957721cb92856a0), U64_C(0x127c35704a5e6768)}, {U64_C(0xe7ad4ea3e7726c48), U64_C(0x171b42cc5cf60142)},
+    {U64_C(0xa198a24ce14f075a), U64_C(0x1ce2137f74338193)}, {U64_C(0x44ff65700cd16498), U64_C(0x120d4c2fa8a030fc)},
+    {U64_C(0x563f3ecc1005bdbe), U64_C(0x16909f3b92c83d3b)}, {U64_C(0x2bcf0e7f14072d2e), U64_C(0x1c34c70a777a4c8a)},
+    {U64_C(0x5b61690f6c847c3d), U64_C(0x11a0fc668aac6fd6)}, {U64_C(0xf239c35347a59b4c), U64_C(0x16093b802d578bcb)},
+    {U64_C(0xeec83428198f021f), U64_C(0x1b8b8a6038ad6ebe)}, {U64_C(0x553d20990ff96153), U64_C(0x1137367c236c6537)},
+    {U64_C(0x2a8c68bf53f7b9a8), U64_C(0x1585041b2c477e85)}, {U64_C(0x752f82ef28f5a812), U64_C(0x1ae64521f7595e26)},
+    {U64_C(0x093db1d57999890b), U64_C(0x10cfeb353a97dad8)}, {U64_C(0x0b8d1e4ad7ffeb4e), U64_C(0x1503e602893dd18e)},
+    {U64_C(0x8e7065dd8dffe622), U64_C(0x1a44df832b8d45f1)}, {U64_C(0xf9063faa78bfefd5), U64_C(0x106b0bb1fb384bb6)},
+    {U64_C(0xb747cf9516efebca), U64_C(0x1485ce9e7a065ea4)}, {U64_C(0xe519c37a5cabe6bd), U64_C(0x19a742461887f64d)},
+    {U64_C(0xaf301a2c79eb7036), U64_C(0x1008896bcf54f9f0)}, {U64_C(0xdafc20b798664c43), U64_C(0x140aabc6c32a386c)},
+    {U64_C(0x11bb28e57e7fdf54), U64_C(0x190d56b873f4c688)}, {U64_C(0x1629f31ede1fd72a), U64_C(0x1f50ac6690f1f82a)},
+    {U64_C(0x4dda37f34ad3e67a), U64_C(0x13926bc01a973b1a)}, {U64_C(0xe150c5f01d88e019), U64_C(0x187706b0213d09e0)},
+    {U64_C(0x19a4f76c24eb181f), U64_C(0x1e94c85c298c4c59)}, {U64_C(0xb0071aa39712ef13), U64_C(0x131cfd3999f7afb7)},
+    {U64_C(0x9c08e14c7cd7aad8), U64_C(0x17e43c8800759ba5)}, {U64_C(0x030b199f9c0d958e), U64_C(0x1ddd4baa0093028f)},
+    {U64_C(0x61e6f003c1887d79), U64_C(0x12aa4f4a405be199)}, {U64_C(0xba60ac04b1ea9cd7), U64_C(0x1754e31cd072d9ff)},
+    {U64_C(0xa8f8d705de65440d), U64_C(0x1d2a1be4048f907f)}, {U64_C(0xc99b8663aaff4a88), U64_C(0x123a516e82d9ba4f)},
+    {U64_C(0xbc0267fc95bf1d2a), U64_C(0x16c8e5ca239028e3)}, {U64_C(0xab0301fbbb2ee474), U64_C(0x1c7b1f3cac74331c)},
+    {U64_C(0xeae1e13d54fd4ec9), U64_C(0x11ccf385ebc89ff1)}, {U64_C(0x659a598caa3ca27b), U64_C(0x1640306766bac7ee)},
+    {U64_C(0xff00efefd4cbcb1a), U64_C(0x1bd03c81406979e9)}, {U64_C(0x3f6095f5e4ff5ef0), U64_C(0x116225d0c841ec32)},
+    {U64_C(0xcf38bb735e3f36ac), U64_C(0x15baaf44fa52673e)}, {U64_C(0x8306ea5035cf0457), U64_C(0x1b295b1638e7010e)},
+    {U64_C(0x11e4527221a162b6), U64_C(0x10f9d8ede39060a9)}, {U64_C(0x565d670eaa09bb64), U64_C(0x15384f295c7478d3)},
+    {U64_C(0x2bf4c0d2548c2a3d), U64_C(0x1a8662f3b3919708)}, {U64_C(0x1b78f88374d79a66), U64_C(0x1093fdd8503afe65)},
+    {U64_C(0x625736a4520d8100), U64_C(0x14b8fd4e6449bdfe)}, {U64_C(0xfaed044d6690e140), U64_C(0x19e73ca1fd5c2d7d)},
+    {U64_C(0xbcd422b0601a8cc8), U64_C(0x103085e53e599c6e)}, {U64_C(0x6c092b5c78212ffa), U64_C(0x143ca75e8df0038a)},
+    {U64_C(0x070b763396297bf8), U64_C(0x194bd136316c046d)}, {U64_C(0x48ce53c07bb3daf6), U64_C(0x1f9ec583bdc70588)},
+    {U64_C(0x2d80f4584d5068da), U64_C(0x13c33b72569c6375)}, {U64_C(0x78e1316e60a48310), U64_C(0x18b40a4eec437c52)},
+};
+
+static inline i32 Format__Pow5Bits(i32 e) // ceil(log2(5^e)), 1 for e = 0
+{
+    return (i32)(((u32)e * 1217359) >> 19) + 1;
+}
+
+static inline u32 Format__Log10Pow2(i32 e) // floor(log10(2^e))
+{
+    return ((u32)e * 78913) >> 18;
+}
+
+static inline u32 Format__Log10Pow5(i32 e) // floor(log10(5^e))
+{
+    return ((u32)e * 732923) >> 20;
+}
+
+static inline bool Format__MultipleOfPow5(u64 value, u32 p)
+{
+    u32 count = 0;
+    while (value % 5 == 0) {
+        value /= 5;
+        count++;
+    }
+
+    return count >= p;
+}
+
+static inline bool Format__MultipleOfPow2(u64 value, u32 p)
+{
+    return !(value & ((U64_C(1) << p) - 1));
+}
+
+static inline u64 Format__MulShift(u64 m, const u64 mul[2], i32 j)
+{
+    u128 lo = (u128)m * mul[0];
+    u128 hi = (u128)m * mul[1];
+
+    return (u64)(((lo >> 64) + hi) >> (j - 64));
+}
+
+// shortest decimal for m2 * 2^e2 (e2 already lowered by 2 for the interval), `mm_shift` is 0 when the float is a
+// power of 2 so the interval below is half as wide, `accept_bounds` when the interval ends round to the float itself
+SYM_WEAK
+FormatDecimal Format__Shortest(u64 m2, i32 e2, u32 mm_shift, bool accept_bounds)
+{
+    u64 mv = 4 * m2;
+    u64 vr, vp, vm;
+    i32 e10;
+
+    bool vm_trailing_zeros = false;
+    bool vr_trailing_zeros = false;
+
+    if (e2 >= 0) {
+        u32 q = Format__Log10Pow2(e2) - (e2 > 3);
+        i32 k = FORMAT__POW5_INV_BITCOUNT + Format__Pow5Bits(q) - 1;
+        i32 i = -e2 + (i32)q + k;
+
+        e10 = q;
+        vr  = Format__MulShift(4 * m2, Format__pow5_inv_split[q], i);
+        vp  = Format__MulShift(4 * m2 + 2, Format__pow5_inv_split[q], i);
+        vm  = Format__MulShift(4 * m2 - 1 - mm_shift, Format__pow5_inv_split[q], i);
+
+        // past 5^21 none of mv, mp, mm can be a multiple of 5^q
+        if (q <= 21) {
+            if (mv % 5 == 0) {
+                vr_trailing_zeros = Format__MultipleOfPow5(mv, q);
+            } else if (accept_bounds) {
+                vm_trailing_zeros = Format__MultipleOfPow5(mv - 1 - mm_shift, q);
+            } else {
+                vp -= Format__MultipleOfPow5(mv + 2, q);
+            }
+        }
+    } else {
+        u32 q = Format__Log10Pow5(-e2) - (-e2 > 1);
+        i32 i = -e2 - (i32)q;
+        i32 k = Format__Pow5Bits(i) - FORMAT__POW5_BITCOUNT;
+        i32 j = (i32)q - k;
+
+        e10 = (i32)q + e2;
+        vr  = Format__MulShift(4 * m2, Format__pow5_split[i], j);
+        vp  = Format__MulShift(4 * m2 + 2, Format__pow5_split[i], j);
+        vm  = Format__MulShift(4 * m2 - 1 - mm_shift, Format__pow5_split[i], j);
+
+        if (q <= 1) {
+            // mv has at least q trailing zero bits
+            vr_trailing_zeros = true;
+            if (accept_bounds) {
+                vm_trailing_zeros = mm_shift == 1;
+            } else {
+                vp--;
+            }
+        } else if (q < 63) {
+            vr_trailing_zeros = Format__MultipleOfPow2(mv, q);
+        }
+    }
+
+    i32 removed        = 0;
+    u8  last_removed   = 0;
+    u64 output;
+
+    if (unlikely(vm_trailing_zeros || vr_trailing_zeros)) {
+        // the exact interval ends or the value are themselves short decimals, track that to round correctly
+        while (vp / 10 > vm / 10) {
+            vm_trailing_zeros &= vm % 10 == 0;
+            vr_trailing_zeros &= last_removed == 0;
+            last_removed       = vr % 10;
+
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+
+        if (vm_trailing_zeros) {
+            while (vm % 10 == 0) {
+                vr_trailing_zeros &= last_removed == 0;
+                last_removed       = vr % 10;
+
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                removed++;
+            }
+        }
+
+        // round half to even when the exact value is ...50000
+        if (vr_trailing_zeros && last_removed == 5 && vr % 2 == 0) last_removed = 4;
+
+        output = vr + ((vr == vm && (!accept_bounds || !vm_trailing_zeros)) || last_removed >= 5);
+    } else {
+        bool round_up = false;
+
+        // most of the time at least two digits go, drop them in one step
+        if (vp / 100 > vm / 100) {
+            round_up = vr % 100 >= 50;
+
+            vr /= 100;
+            vp /= 100;
+            vm /= 100;
+            removed += 2;
+        }
+
+        while (vp / 10 > vm / 10) {
+            round_up = vr % 10 >= 5;
+
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+
+        output = vr + (vr == vm || round_up);
+    }
+
+    return (FormatDecimal){.mantissa = output, .exponent = e10 + removed};
+}
+
+// plain notation when the leading digit's decimal exponent is in [-6, 20], scientific otherwise
+SYM_WEAK
+usize Format__PrintDecimal(char* dst, FormatDecimal dec, bool negative)
+{
+    char* at = dst;
+    if (negative) *at++ = '-';
+
+    i32 len   = Format__DecimalLength(dec.mantissa);
+    i32 point = len + dec.exponent; // digits before the decimal point
+
+    if (point > -6 && point <= 21) {
+        if (point <= 0) {
+            memcpy(at, "0.000000", 2 - point);
+            at += 2 - point;
+            Format__Digits(at, dec.mantissa, len);
+            at += len;
+        } else if (point >= len) {
+            Format__Digits(at, dec.mantissa, len);
+            memset(at + len, '0', point - len);
+            at += point;
+        } else {
+            Format__Digits(at + 1, dec.mantissa, len);
+            memmove(at, at + 1, point);
+            at[point] = '.';
+            at += len + 1;
+        }
+    } else {
+        Format__Digits(at + 1, dec.mantissa, len);
+        at[0] = at[1];
+        if (len > 1) {
+            at[1] = '.';
+            at   += len + 1;
+        } else {
+            at += 1;
+        }
+
+        i32 exponent = point - 1;
+        *at++        = 'e';
+        *at++        = exponent < 0 ? '-' : '+';
+        at          += Format_U64ToChars(at, exponent < 0 ? -exponent : exponent);
+    }
+
+    return at - dst;
+}
+
+// nan, inf and zero, 0 if `value` is none of them
+static inline usize Format__SpecialFloat(char* dst, bool negative, bool nan, bool inf, bool zero)
+{
+    if (nan) {
+        memcpy(dst, "nan", 3);
+        return 3;
+    }
+
+    if (!inf && !zero) return 0;
+
+    char* at = dst;
+    if (negative) *at++ = '-';
+
+    if (inf) {
+        memcpy(at, "inf", 3);
+        return at + 3 - dst;
+    }
+
+    *at = '0';
+    return at + 1 - dst;
+}
+
+SYM_WEAK
+usize Format_F64ToChars(char* dst, f64 value)
+{
+    f64_ieee754 bits = {.f64 = value};
+
+    usize special = Format__SpecialFloat(dst, bits.sign, bits.exp == 0x7FF && bits.frac, bits.exp == 0x7FF && !bits.frac, !bits.exp && !bits.frac);
+    if (special) return special;
+
+    u64 m2 = bits.exp ? (U64_C(1) << 52) | bits.frac : bits.frac;
+    i32 e2 = (bits.exp ? (i32)bits.exp : 1) - 1023 - 52 - 2;
+
+    FormatDecimal dec = Format__Shortest(m2, e2, bits.frac != 0 || bits.exp <= 1, (m2 & 1) == 0);
+    return Format__PrintDecimal(dst, dec, bits.sign);
+}
+
+SYM_WEAK
+usize Format_F32ToChars(char* dst, f32 value)
+{
+    f32_ieee754 bits = {.f32 = value};
+
+    usize special = Format__SpecialFloat(dst, bits.sign, bits.exp == 0xFF && bits.frac, bits.exp == 0xFF && !bits.frac, !bits.exp && !bits.frac);
+    if (special) return special;
+
+    u64 m2 = bits.exp ? (U32_C(1) << 23) | bits.frac : bits.frac;
+    i32 e2 = (bits.exp ? (i32)bits.exp : 1) - 127 - 23 - 2;
+
+    FormatDecimal dec = Format__Shortest(m2, e2, bits.frac != 0 || bits.exp <= 1, (m2 & 1) == 0);
+    return Format__PrintDecimal(dst, dec, bits.sign);
+}
+
+/* --- Values --- */
+
+SYM_WEAK
+void Format_Bytes(FormatSink* self, const void* data, usize len)
+{
+    Format__Write(self, data, len);
+}
+
+SYM_WEAK
+void Format_CStr(FormatSink* self, const char* cstr)
+{
+    Format__Write(self, cstr, strlen(cstr));
+}
+
+SYM_WEAK
+void Format_String(FormatSink* self, const String* str)
+{
+    Format__Write(self, str->at, str->len);
+}
+
+SYM_WEAK
+void Format_StringView(FormatSink* self, StringView sv)
+{
+    Format__Write(self, sv.at, sv.len);
+}
+
+SYM_WEAK
+void Format_Char(FormatSink* self, char c)
+{
+    Format__Write(self, &c, 1);
+}
+
+SYM_WEAK
+void Format_Bool(FormatSink* self, bool value)
+{
+    if (value) {
+        Format__Write(self, "true", 4);
+    } else {
+        Format__Write(self, "false", 5);
+    }
+}
+
+// numbers are converted straight into the window when it has room for the longest output
+#define FORMAT__NUMBER(_self, _max, _convert, _value)            \
+    do {                                                         \
+        if (likely((usize)((_self)->end - (_self)->at) >= (_max))) { \
+            usize len_   = _convert((_self)->at, (_value));      \
+            (_self)->at  += len_;                                \
+            (_self)->len += len_;                                \
+        } else {                                                 \
+            char tmp_[_max];                                     \
+            Format__Write((_self), tmp_, _convert(tmp_, (_value))); \
+        }                                                        \
+    } while (0)
+
+SYM_WEAK
+void Format_I64(FormatSink* self, i64 value)
+{
+    FORMAT__NUMBER(self, FORMAT_I64_MAX, Format_I64ToChars, value);
+}
+
+SYM_WEAK
+void Format_U64(FormatSink* self, u64 value)
+{
+    FORMAT__NUMBER(self, FORMAT_U64_MAX, Format_U64ToChars, value);
+}
+
+SYM_WEAK
+void Format_F64(FormatSink* self, f64 value)
+{
+    FORMAT__NUMBER(self, FORMAT_F64_MAX, Format_F64ToChars, value);
+}
+
+SYM_WEAK
+void Format_F32(FormatSink* self, f32 value)
+{
+    FORMAT__NUMBER(self, FORMAT_F32_MAX, Format_F32ToChars, value);
+}
+
+SYM_WEAK
+void Format_Hex(FormatSink* self, FormatHex hex)
+{
+    static const char digits[16] = "0123456789abcdef";
+    static const char zeros[16]  = "0000000000000000";
+
+    usize len = ilog2_64(hex.value | 1) / 4 + 1;
+    for (usize pad = hex.width > len ? hex.width - len : 0; pad;) {
+        usize part = min(pad, sizeof(zeros));
+        Format__Write(self, zeros, part);
+        pad -= part;
+    }
+
+    char tmp[16];
+    for (usize ii = len; ii--;) {
+        tmp[ii]     = digits[hex.value & 0xF];
+        hex.value >>= 4;
+    }
+
+    Format__Write(self, tmp, len);
+}
+
+SYM_WEAK
+void Format_Ptr(FormatSink* self, const void* ptr)
+{
+    Format__Write(self, "0x", 2);
+    Format_Hex(self, FMT_HEX((uptr)ptr));
+}
@@ -0,0 +1,241 @@
+#ifndef T
+# error "MpmcQueue type `T` must be defined before `mpmc_queue.h` is included"
+#endif
+
+// Bounded multi-producer/multi-consumer queue (Vyukov). Every cell carries a sequence number that tells
+// producers and consumers whose turn it is, so the only contended state is one position counter per side.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sched.h>
+
+#include <deggua/macros.h>
+
+#ifndef CONCAT2_
+# define CONCAT2_(x, y) x ## _ ## y
+#endif
+
+#ifndef CONCAT2
+# define CONCAT2(x, y) CONCAT2_(x, y)
+#endif
+
+#define MpmcQueue(T)             CONCAT2(MpmcQueue, T)
+
+#define MpmcQueue_New(T)         CONCAT2(MpmcQueue_New, T)
+#define MpmcQueue_Delete(T)      CONCAT2(MpmcQueue_Delete, T)
+
+#define MpmcQueue_TryPush(T)     CONCAT2(MpmcQueue_TryPush, T)
+#define MpmcQueue_TryPushMany(T) CONCAT2(MpmcQueue_TryPushMany, T)
+#define MpmcQueue_Push(T)        CONCAT2(MpmcQueue_Push, T)
+#define MpmcQueue_PushMany(T)    CONCAT2(MpmcQueue_PushMany, T)
+
+#define MpmcQueue_TryPop(T)      CONCAT2(MpmcQueue_TryPop, T)
+#define MpmcQueue_TryPopMany(T)  CONCAT2(MpmcQueue_TryPopMany, T)
+#define MpmcQueue_Pop(T)         CONCAT2(MpmcQueue_Pop, T)
+#define MpmcQueue_PopMany(T)     CONCAT2(MpmcQueue_PopMany, T)
+
+#define MpmcQueue_Length(T)      CONCAT2(MpmcQueue_Length, T)
+
+#define MpmcQueue__Cell(T)       CONCAT2(MpmcQueue__Cell, T)
+#define MpmcQueue__Backoff(T)    CONCAT2(MpmcQueue__Backoff, T)
+
+typedef struct {
+    size_t seq;
+    T      value;
+} MpmcQueue__Cell(T);
+
+typedef struct {
+    MpmcQueue__Cell(T)* cells;
+    size_t              mask;
+
+    size_t enqueue_pos ATTR(aligned(TARGET_CACHE_LINE_SIZE));
+    size_t dequeue_pos ATTR(aligned(TARGET_CACHE_LINE_SIZE));
+} MpmcQueue(T);
+
+SYM_WEAK
+bool MpmcQueue_New(T)(MpmcQueue(T)* this, size_t min_capacity)
+{
+    size_t capacity = 2;
+    while (capacity < min_capacity) capacity *= 2;
+
+    MpmcQueue__Cell(T)* cells = MALLOC(capacity * sizeof(MpmcQueue__Cell(T)));
+    if (!cells) return false;
+
+    for (size_t ii = 0; ii < capacity; ii++) {
+        cells[ii].seq = ii;
+    }
+
+    this->cells       = cells;
+    this->mask        = capacity - 1;
+    this->enqueue_pos = 0;
+    this->dequeue_pos = 0;
+
+    return true;
+}
+
+SYM_WEAK
+void MpmcQueue_Delete(T)(MpmcQueue(T)* this)
+{
+    FREE(this->cells);
+}
+
+// spin briefly, then give the core away, used by the blocking variants
+SYM_WEAK
+void MpmcQueue__Backoff(T)(size_t* attempt)
+{
+    if (*attempt < 64) {
+        size_t spins = (size_t)1 << min(*attempt, (size_t)6);
+        for (size_t ii = 0; ii < spins; ii++) {
+            CPU_RELAX();
+        }
+    } else {
+        sched_yield();
+    }
+
+    *attempt += 1;
+}
+
+SYM_WEAK
+size_t MpmcQueue_TryPushMany(T)(MpmcQueue(T)* this, const T* restrict elems, size_t count)
+{
+    if (!count) return 0;
+
+    size_t pos = __atomic_load_n(&this->enqueue_pos, __ATOMIC_RELAXED);
+
+    for (;;) {
+        // claim the longest run of free cells, a cell is free for `pos` once its seq reaches `pos`
+        size_t nfree = 0;
+        while (nfree < count) {
+            size_t seq = __atomic_load_n(&this->cells[(pos + nfree) & this->mask].seq, __ATOMIC_ACQUIRE);
+            if (seq != pos + nfree) break;
+            nfree++;
+        }
+
+        if (!nfree) {
+            // full, unless another producer claimed `pos` and we're behind
+            size_t seq = __atomic_load_n(&this->cells[pos & this->mask].seq, __ATOMIC_ACQUIRE);
+            if ((intptr_t)(seq - pos) < 0) return 0;
+
+            pos = __atomic_load_n(&this->enqueue_pos, __ATOMIC_RELAXED);
+            continue;
+        }
+
+        if (__atomic_compare_exchange_n(&this->enqueue_pos, &pos, pos + nfree, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            for (size_t ii = 0; ii < nfree; ii++) {
+                MpmcQueue__Cell(T)* cell = &this->cells[(pos + ii) & this->mask];
+
+                cell->value = elems[ii];
+                __atomic_store_n(&cell->seq, pos + ii + 1, __ATOMIC_RELEASE);
+            }
+
+            return nfree;
+        }
+    }
+}
+
+SYM_WEAK
+bool MpmcQueue_TryPush(T)(MpmcQueue(T)* this, const T* restrict elem)
+{
+    return MpmcQueue_TryPushMany(T)(this, elem, 1) == 1;
+}
+
+SYM_WEAK
+void MpmcQueue_PushMany(T)(MpmcQueue(T)* this, const T* restrict elems, size_t count)
+{
+    size_t attempt = 0;
+    while (count) {
+        size_t pushed = MpmcQueue_TryPushMany(T)(this, elems, count);
+        if (pushed) {
+            elems  += pushed;
+            count  -= pushed;
+            attempt = 0;
+        } else {
+            MpmcQueue__Backoff(T)(&attempt);
+        }
+    }
+}
+
+SYM_WEAK
+void MpmcQueue_Push(T)(MpmcQueue(T)* this, const T* restrict elem)
+{
+    MpmcQueue_PushMany(T)(this, elem, 1);
+}
+
+SYM_WEAK
+size_t MpmcQueue_TryPopMany(T)(MpmcQueue(T)* this, T* restrict elems, size_t count)
+{
+    if (!count) return 0;
+
+    size_t pos = __atomic_load_n(&this->dequeue_pos, __ATOMIC_RELAXED);
+
+    for (;;) {
+        // claim the longest run of full cells, a cell holds the value for `pos` once its seq reaches `pos + 1`
+        size_t nfull = 0;
+        while (nfull < count) {
+            size_t seq = __atomic_load_n(&this->cells[(pos + nfull) & this->mask].seq, __ATOMIC_ACQUIRE);
+            if (seq != pos + nfull + 1) break;
+            nfull++;
+        }
+
+        if (!nfull) {
+            // empty, unless another consumer claimed `pos` and we're behind
+            size_t seq = __atomic_load_n(&this->cells[pos & this->mask].seq, __ATOMIC_ACQUIRE);
+            if ((intptr_t)(seq - (pos + 1)) < 0) return 0;
+
+            pos = __atomic_load_n(&this->dequeue_pos, __ATOMIC_RELAXED);
+            continue;
+        }
+
+        if (__atomic_compare_exchange_n(&this->dequeue_pos, &pos, pos + nfull, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            for (size_t ii = 0; ii < nfull; ii++) {
+                MpmcQueue__Cell(T)* cell = &this->cells[(pos + ii) & this->mask];
+
+                elems[ii] = cell->value;
+                __atomic_store_n(&cell->seq, pos + ii + this->mask + 1, __ATOMIC_RELEASE);
+            }
+
+            return nfull;
+        }
+    }
+}
+
+SYM_WEAK
+bool MpmcQueue_TryPop(T)(MpmcQueue(T)* this, T* restrict elem)
+{
+    return MpmcQueue_TryPopMany(T)(this, elem, 1) == 1;
+}
+
+SYM_WEAK
+size_t MpmcQueue_PopMany(T)(MpmcQueue(T)* this, T* restrict elems, size_t count)
+{
+    size_t attempt = 0;
+    for (;;) {
+        size_t popped = MpmcQueue_TryPopMany(T)(this, elems, count);
+        if (popped || !count) return popped;
+
+        MpmcQueue__Backoff(T)(&attempt);
+    }
+}
+
+SYM_WEAK
+void MpmcQueue_Pop(T)(MpmcQueue(T)* this, T* restrict elem)
+{
+    MpmcQueue_PopMany(T)(this, elem, 1);
+}
+
+SYM_WEAK
+size_t MpmcQueue_Length(T)(const MpmcQueue(T)* this)
+{
+    size_t dequeue = __atomic_load_n(&this->dequeue_pos, __ATOMIC_RELAXED);
+    size_t enqueue = __atomic_load_n(&this->enqueue_pos, __ATOMIC_RELAXED);
+
+    // the positions are read separately, clamp in case producers raced ahead in between
+    return min(enqueue - dequeue, this->mask + 1);
+}
+
+#undef MpmcQueue__Backoff
+
+#undef T
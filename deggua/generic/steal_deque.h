@@ -0,0 +1,132 @@
+#ifndef T
+# error "StealDeque type `T` must be defined before `steal_deque.h` is included"
+#endif
+
+// Bounded work stealing deque (Chase-Lev). The owning thread pushes and pops at the bottom without atomic RMWs
+// (except when racing for the last element), any thread can steal from the top.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <deggua/macros.h>
+
+#ifndef CONCAT2_
+# define CONCAT2_(x, y) x ## _ ## y
+#endif
+
+#ifndef CONCAT2
+# define CONCAT2(x, y) CONCAT2_(x, y)
+#endif
+
+#define StealDeque(T)        CONCAT2(StealDeque, T)
+
+#define StealDeque_New(T)    CONCAT2(StealDeque_New, T)
+#define StealDeque_Delete(T) CONCAT2(StealDeque_Delete, T)
+
+#define StealDeque_Push(T)   CONCAT2(StealDeque_Push, T)
+#define StealDeque_Pop(T)    CONCAT2(StealDeque_Pop, T)
+#define StealDeque_Steal(T)  CONCAT2(StealDeque_Steal, T)
+#define StealDeque_Length(T) CONCAT2(StealDeque_Length, T)
+
+typedef struct {
+    T*     buffer;
+    size_t mask;
+
+    size_t top    ATTR(aligned(TARGET_CACHE_LINE_SIZE)); // next element to steal
+    size_t bottom ATTR(aligned(TARGET_CACHE_LINE_SIZE)); // next free slot, only written by the owner
+} StealDeque(T);
+
+SYM_WEAK
+bool StealDeque_New(T)(StealDeque(T)* this, size_t min_capacity)
+{
+    size_t capacity = 2;
+    while (capacity < min_capacity) capacity *= 2;
+
+    this->buffer = MALLOC(capacity * sizeof(T));
+    if (!this->buffer) return false;
+
+    this->mask   = capacity - 1;
+    this->top    = 0;
+    this->bottom = 0;
+
+    return true;
+}
+
+SYM_WEAK
+void StealDeque_Delete(T)(StealDeque(T)* this)
+{
+    FREE(this->buffer);
+}
+
+// owner only, fails when the deque is full
+SYM_WEAK
+bool StealDeque_Push(T)(StealDeque(T)* this, const T* restrict elem)
+{
+    size_t bottom = __atomic_load_n(&this->bottom, __ATOMIC_RELAXED);
+    size_t top    = __atomic_load_n(&this->top, __ATOMIC_ACQUIRE);
+
+    if (bottom - top > this->mask) return false;
+
+    this->buffer[bottom & this->mask] = *elem;
+    __atomic_store_n(&this->bottom, bottom + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+// owner only, takes the most recently pushed element
+SYM_WEAK
+bool StealDeque_Pop(T)(StealDeque(T)* this, T* restrict elem)
+{
+    size_t bottom = __atomic_load_n(&this->bottom, __ATOMIC_RELAXED) - 1;
+    __atomic_store_n(&this->bottom, bottom, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    size_t top = __atomic_load_n(&this->top, __ATOMIC_RELAXED);
+
+    if ((intptr_t)(bottom - top) < 0) {
+        __atomic_store_n(&this->bottom, bottom + 1, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    *elem = this->buffer[bottom & this->mask];
+    if (bottom != top) return true;
+
+    // last element, race the thieves for it
+    bool won = __atomic_compare_exchange_n(&this->top, &top, top + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+    __atomic_store_n(&this->bottom, bottom + 1, __ATOMIC_RELAXED);
+
+    return won;
+}
+
+// any thread (including the owner), takes the oldest element, only fails when the deque is empty
+SYM_WEAK
+bool StealDeque_Steal(T)(StealDeque(T)* this, T* restrict elem)
+{
+    size_t top = __atomic_load_n(&this->top, __ATOMIC_ACQUIRE);
+
+    for (;;) {
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        size_t bottom = __atomic_load_n(&this->bottom, __ATOMIC_ACQUIRE);
+
+        if ((intptr_t)(bottom - top) <= 0) return false;
+
+        // read before claiming, the slot can only be reused once `top` moves past it
+        T value = this->buffer[top & this->mask];
+        if (__atomic_compare_exchange_n(&this->top, &top, top + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_ACQUIRE)) {
+            *elem = value;
+            return true;
+        }
+    }
+}
+
+SYM_WEAK
+size_t StealDeque_Length(T)(const StealDeque(T)* this)
+{
+    size_t top    = __atomic_load_n(&this->top, __ATOMIC_RELAXED);
+    size_t bottom = __atomic_load_n(&this->bottom, __ATOMIC_RELAXED);
+
+    return (intptr_t)(bottom - top) > 0 ? bottom - top : 0;
+}
+
+#undef T
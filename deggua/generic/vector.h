@@ -53,9 +53,9 @@ typedef struct {
 SYM_WEAK
 bool Vector_New(T)(Vector(T)* this, size_t init_capacity)
 {
-    init_capacity = max(1, init_capacity);
+    init_capacity = max((size_t)1, init_capacity);
 
-    T* alloc = malloc(init_capacity * sizeof(T));
+    T* alloc = MALLOC(init_capacity * sizeof(T));
     if (!alloc) return false;
 
     this->capacity = init_capacity;
@@ -68,7 +68,7 @@ bool Vector_New(T)(Vector(T)* this, size_t init_capacity)
 SYM_WEAK
 bool Vector_New_Copy(T)(Vector(T)* this, const Vector(T)* restrict src)
 {
-    T* alloc = malloc(src->capacity * sizeof(T));
+    T* alloc = MALLOC(src->capacity * sizeof(T));
     if (!alloc) return false;
 
     memcpy(alloc, src->at, src->capacity * sizeof(T));
@@ -83,7 +83,7 @@ bool Vector_New_Copy(T)(Vector(T)* this, const Vector(T)* restrict src)
 SYM_WEAK
 void Vector_Delete(T)(Vector(T)* this)
 {
-    free(this->at);
+    FREE(this->at);
 }
 
 #define Vector__ChangeCapacity(T) CONCAT2(Vector__ChangeCapacity, T)
@@ -91,9 +91,9 @@ void Vector_Delete(T)(Vector(T)* this)
 SYM_WEAK
 bool Vector__ChangeCapacity(T)(Vector(T)* this, size_t capacity)
 {
-    capacity = max(1, capacity);
+    capacity = max((size_t)1, capacity);
 
-    T* new_alloc = realloc(this->at, capacity * sizeof(T));
+    T* new_alloc = REALLOC(this->at, capacity * sizeof(T));
     if (!new_alloc) return false;
 
     this->at       = new_alloc;
@@ -0,0 +1,338 @@
+#pragma once
+
+#include <pthread.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include <deggua/types.h>
+#include <deggua/units.h>
+#include <deggua/arena.h>
+
+// Drop-in malloc replacement, small sizes are served from per-thread caches of segregated size classes carved
+// out of one MemoryArena, large sizes are mapped directly. Memory freed by a thread other than the one that
+// allocated it is queued back to the owning cache lock-free. Caches of exited threads are adopted by new threads.
+//
+// Containers can be routed through the heap by defining the allocator macros from macros.h before including them:
+//     #define MALLOC(size)       Heap_Alloc(size)
+//     #define REALLOC(ptr, size) Heap_Realloc(ptr, size)
+//     #define FREE(ptr)          Heap_Free(ptr)
+
+#define HEAP_RESERVE_SIZE (64 * GiB)  // virtual space reserved for small allocations
+#define HEAP_SPAN_SIZE    (256 * KiB) // unit of memory a thread cache takes from the arena for one size class
+#define HEAP_SMALL_MAX    (16 * KiB)  // largest size served from the size classes
+#define HEAP_SIZE_CLASSES (36)        // 16 byte steps up to 128, then 4 classes per power of 2 up to HEAP_SMALL_MAX
+
+typedef struct HeapBlock {
+    struct HeapBlock* next;
+} HeapBlock;
+
+typedef struct HeapCache {
+    HeapBlock* remote_free ATTR(aligned(TARGET_CACHE_LINE_SIZE)); // blocks freed by other threads (MPSC stack)
+
+    struct HeapCache* next_orphan ATTR(aligned(TARGET_CACHE_LINE_SIZE)); // link while the owning thread is gone
+
+    struct {
+        HeapBlock* free_list; // freed blocks of this class
+        char*      bump;      // next never-used block in the current span
+        char*      bump_end;  // end of the current span
+    } bins[HEAP_SIZE_CLASSES];
+} HeapCache;
+
+// lives at the start of every span, found by masking a block's address
+typedef struct {
+    HeapCache* owner;
+    u32        size_class;
+} HeapSpan;
+
+// lives in front of every large allocation
+typedef struct {
+    usize map_size;
+    usize pad_;
+} HeapLarge;
+
+typedef struct {
+    MemoryArena    arena;   // span reservation
+    HeapCache*     orphans; // caches of exited threads, waiting for adoption
+    pthread_key_t  key;     // runs the thread exit destructor
+    pthread_once_t once;
+    u32            lock;    // guards span carving and the orphan list
+    bool           ready;
+} Heap;
+
+/* --- Heap Allocation --- */
+
+void* Heap_Alloc(usize size);              // Allocate `size` bytes, 16 byte aligned (uninitialized)
+void* Heap_ZAlloc(usize size);             // Allocate `size` bytes, 16 byte aligned (zero filled)
+void* Heap_Realloc(void* ptr, usize size); // Resize an allocation, same semantics as realloc
+void  Heap_Free(void* ptr);                // Free an allocation, may be called from any thread
+usize Heap_UsableSize(const void* ptr);    // Size actually reserved for an allocation (>= the requested size)
+
+/* --- Implementation --- */
+
+SYM_WEAK Heap Heap__global = {.once = PTHREAD_ONCE_INIT};
+SYM_WEAK _Thread_local HeapCache* Heap__cache;
+
+static inline usize Heap__SizeClass(usize size)
+{
+    if (size <= 128) return size ? (size - 1) / 16 : 0;
+
+    usize lg = ilog2_64(size - 1);
+    return 8 + (lg - 7) * 4 + ((size - 1 - (USIZE_C(1) << lg)) >> (lg - 2));
+}
+
+static inline usize Heap__ClassSize(usize size_class)
+{
+    if (size_class < 8) return (size_class + 1) * 16;
+
+    usize kk = size_class - 8;
+    usize lg = 7 + kk / 4;
+    return (USIZE_C(1) << lg) + (kk % 4 + 1) * (USIZE_C(1) << (lg - 2));
+}
+
+static inline void Heap__Lock(Heap* heap)
+{
+    while (__atomic_exchange_n(&heap->lock, 1, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(&heap->lock, __ATOMIC_RELAXED)) {
+            CPU_RELAX();
+        }
+    }
+}
+
+static inline void Heap__Unlock(Heap* heap)
+{
+    __atomic_store_n(&heap->lock, 0, __ATOMIC_RELEASE);
+}
+
+static inline bool Heap__IsSmall(const void* ptr)
+{
+    return (uptr)ptr - (uptr)Heap__global.arena.base < Heap__global.arena.virt_size;
+}
+
+// thread exit, the cache is parked until another thread adopts it (remote frees keep queueing meanwhile)
+SYM_WEAK
+void Heap__ThreadExit(void* arg)
+{
+    HeapCache* cache = arg;
+    Heap*      heap  = &Heap__global;
+
+    Heap__cache = NULL;
+
+    Heap__Lock(heap);
+    cache->next_orphan = heap->orphans;
+    heap->orphans      = cache;
+    Heap__Unlock(heap);
+}
+
+SYM_WEAK
+void Heap__Init(void)
+{
+    Heap* heap = &Heap__global;
+
+    if (!MemoryArena_New_Policy(&heap->arena, HEAP_RESERVE_SIZE, 4 * HEAP_SPAN_SIZE, MEMORY_ARENA_FLAG_HUGE_PAGES)) return;
+    if (pthread_key_create(&heap->key, Heap__ThreadExit)) return;
+
+    __atomic_store_n(&heap->ready, true, __ATOMIC_RELEASE);
+}
+
+SYM_WEAK
+HeapCache* Heap__AcquireCache(void)
+{
+    Heap* heap = &Heap__global;
+
+    pthread_once(&heap->once, Heap__Init);
+    if (!__atomic_load_n(&heap->ready, __ATOMIC_ACQUIRE)) return NULL;
+
+    Heap__Lock(heap);
+
+    HeapCache* cache = heap->orphans;
+    if (cache) {
+        heap->orphans = cache->next_orphan;
+    } else {
+        cache = MemoryArena_ZAlignedAlloc(&heap->arena, TARGET_CACHE_LINE_SIZE, sizeof(HeapCache));
+    }
+
+    Heap__Unlock(heap);
+
+    if (!cache) return NULL;
+
+    pthread_setspecific(heap->key, cache);
+    Heap__cache = cache;
+
+    return cache;
+}
+
+// moves blocks freed by other threads onto the local free lists
+SYM_WEAK
+bool Heap__DrainRemote(HeapCache* cache)
+{
+    HeapBlock* block = __atomic_exchange_n(&cache->remote_free, NULL, __ATOMIC_ACQUIRE);
+    if (!block) return false;
+
+    while (block) {
+        HeapBlock* next = block->next;
+        HeapSpan*  span = (HeapSpan*)((uptr)block & ~(uptr)(HEAP_SPAN_SIZE - 1));
+
+        block->next                             = cache->bins[span->size_class].free_list;
+        cache->bins[span->size_class].free_list = block;
+
+        block = next;
+    }
+
+    return true;
+}
+
+SYM_WEAK
+void* Heap__LargeAlloc(usize size)
+{
+    usize map_size = alignp2_64(size + sizeof(HeapLarge), sysconf(_SC_PAGESIZE));
+    if (map_size < size) return NULL;
+
+    HeapLarge* large = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (large == MAP_FAILED) return NULL;
+
+    large->map_size = map_size;
+    return large + 1;
+}
+
+SYM_WEAK
+void* Heap__SmallAlloc(HeapCache* cache, usize size_class)
+{
+    usize class_size = Heap__ClassSize(size_class);
+
+    for (;;) {
+        HeapBlock* block = cache->bins[size_class].free_list;
+        if (likely(block)) {
+            cache->bins[size_class].free_list = block->next;
+            return block;
+        }
+
+        char* bump = cache->bins[size_class].bump;
+        if (bump && bump + class_size <= cache->bins[size_class].bump_end) {
+            cache->bins[size_class].bump = bump + class_size;
+            return bump;
+        }
+
+        if (Heap__DrainRemote(cache)) continue;
+
+        Heap* heap = &Heap__global;
+
+        Heap__Lock(heap);
+        HeapSpan* span = MemoryArena_UAlignedAlloc(&heap->arena, HEAP_SPAN_SIZE, HEAP_SPAN_SIZE);
+        Heap__Unlock(heap);
+
+        if (!span) return NULL;
+
+        span->owner      = cache;
+        span->size_class = size_class;
+
+        cache->bins[size_class].bump     = (char*)span + alignp2_64(sizeof(HeapSpan), 16);
+        cache->bins[size_class].bump_end = (char*)span + HEAP_SPAN_SIZE;
+    }
+}
+
+SYM_WEAK
+void* Heap_Alloc(usize size)
+{
+    if (unlikely(size > HEAP_SMALL_MAX)) return Heap__LargeAlloc(size);
+
+    HeapCache* cache = Heap__cache;
+    if (unlikely(!cache)) {
+        cache = Heap__AcquireCache();
+        if (!cache) return NULL;
+    }
+
+    return Heap__SmallAlloc(cache, Heap__SizeClass(size));
+}
+
+SYM_WEAK
+void* Heap_ZAlloc(usize size)
+{
+    void* ptr = Heap_Alloc(size);
+    if (!ptr) return NULL;
+
+    // fresh large mappings are already zero
+    if (Heap__IsSmall(ptr)) memset(ptr, 0x00, size);
+
+    return ptr;
+}
+
+SYM_WEAK
+void Heap_Free(void* ptr)
+{
+    if (!ptr) return;
+
+    if (unlikely(!Heap__IsSmall(ptr))) {
+        HeapLarge* large = (HeapLarge*)ptr - 1;
+        munmap(large, large->map_size);
+        return;
+    }
+
+    HeapBlock* block = ptr;
+    HeapSpan*  span  = (HeapSpan*)((uptr)ptr & ~(uptr)(HEAP_SPAN_SIZE - 1));
+    HeapCache* owner = span->owner;
+
+    if (likely(owner == Heap__cache)) {
+        block->next                             = owner->bins[span->size_class].free_list;
+        owner->bins[span->size_class].free_list = block;
+        return;
+    }
+
+    HeapBlock* head = __atomic_load_n(&owner->remote_free, __ATOMIC_RELAXED);
+    do {
+        block->next = head;
+    } while (!__atomic_compare_exchange_n(&owner->remote_free, &head, block, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+SYM_WEAK
+usize Heap_UsableSize(const void* ptr)
+{
+    if (!ptr) return 0;
+
+    if (!Heap__IsSmall(ptr)) {
+        const HeapLarge* large = (const HeapLarge*)ptr - 1;
+        return large->map_size - sizeof(HeapLarge);
+    }
+
+    const HeapSpan* span = (const HeapSpan*)((uptr)ptr & ~(uptr)(HEAP_SPAN_SIZE - 1));
+    return Heap__ClassSize(span->size_class);
+}
+
+SYM_WEAK
+void* Heap_Realloc(void* ptr, usize size)
+{
+    if (!ptr) return Heap_Alloc(size);
+
+    if (!size) {
+        Heap_Free(ptr);
+        return NULL;
+    }
+
+    usize usable = Heap_UsableSize(ptr);
+
+    if (Heap__IsSmall(ptr)) {
+        // stay in place unless the block would be more than half empty
+        if (size <= usable && (size > usable / 2 || usable == 16)) return ptr;
+    } else if (size > HEAP_SMALL_MAX) {
+        HeapLarge* large    = (HeapLarge*)ptr - 1;
+        usize      map_size = alignp2_64(size + sizeof(HeapLarge), sysconf(_SC_PAGESIZE));
+        if (map_size < size) return NULL;
+        if (map_size == large->map_size) return ptr;
+
+#ifdef MREMAP_MAYMOVE
+        // large to large, let the kernel move the pages instead of copying them
+        large = mremap(large, large->map_size, map_size, MREMAP_MAYMOVE);
+        if (large == MAP_FAILED) return NULL;
+
+        large->map_size = map_size;
+        return large + 1;
+#endif
+    }
+
+    void* new_ptr = Heap_Alloc(size);
+    if (!new_ptr) return NULL;
+
+    memcpy(new_ptr, ptr, min(size, usable));
+    Heap_Free(ptr);
+
+    return new_ptr;
+}
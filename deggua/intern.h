@@ -0,0 +1,266 @@
+#pragma once
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <deggua/types.h>
+#include <deggua/arena.h>
+#include <deggua/string.h>
+#include <deggua/threads.h>
+
+// String interning. Every distinct byte string gets one canonical String stored in the table's arena, so interned
+// strings compare equal exactly when their pointers do and duplicates share memory. Interned strings live (and
+// stay valid) until the table is deleted.
+//
+// Lookups never lock: the slots are an open addressed array of tags (32 bits of the hash) with the strings beside
+// them, an insert fills the string before publishing the tag. Inserts take a Mutex, growing publishes a new slot array
+// and leaves the old one in the arena for readers still probing it, the old arrays add up to less than the current one.
+
+#define INTERN_TABLE_MIN_SLOTS (64)
+
+typedef struct {
+    usize          mask;
+    u32*           tags;    // (hash >> 32) | 1, 0 for empty slots
+    const String** strings;
+} InternTableSlots;
+
+typedef struct {
+    InternTableSlots* slots; // current slot array, swapped with a release store when the table grows
+    Mutex             lock;  // serializes inserts
+    usize             count;
+    MemoryArena       arena; // strings and slot arrays
+} InternTable;
+
+bool InternTable_New(InternTable* self, usize max_size); // `max_size` bytes of address space are reserved for the strings and slots
+void InternTable_Delete(InternTable* self);             // Invalidates every interned string
+
+const String* InternTable_Intern(InternTable* self, const void* data, usize len); // Canonical string for the bytes, NULL if out of memory
+const String* InternTable_InternString(InternTable* self, const String* str);
+const String* InternTable_InternView(InternTable* self, StringView sv);
+const String* InternTable_Find(InternTable* self, const void* data, usize len); // Canonical string if already interned, NULL otherwise
+
+usize InternTable_Count(InternTable* self);
+
+/* --- Implementation --- */
+
+static inline u64 InternTable__Mix(u64 a, u64 b)
+{
+    u128 product = (u128)a * b;
+    return (u64)product ^ (u64)(product >> 64);
+}
+
+static inline u64 InternTable__Read64(const u8* ptr)
+{
+    u64 value;
+    memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+static inline u64 InternTable__Read32(const u8* ptr)
+{
+    u32 value;
+    memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+// wyhash, keys are mostly short (header names, identifiers) so those are read with overlapping loads
+static inline u64 InternTable__Hash(const u8* data, usize len)
+{
+    const u64 k0 = U64_C(0xa0761d6478bd642f);
+    const u64 k1 = U64_C(0xe7037ed1a0b428db);
+    const u64 k2 = U64_C(0x8ebc6af09c88c6e3);
+    const u64 k3 = U64_C(0x589965cc75374cc3);
+
+    u64 seed = InternTable__Mix(k0, k1);
+    u64 a, b;
+
+    if (likely(len <= 16)) {
+        if (len >= 4) {
+            usize step = (len >> 3) << 2;
+            a          = (InternTable__Read32(data) << 32) | InternTable__Read32(data + step);
+            b          = (InternTable__Read32(data + len - 4) << 32) | InternTable__Read32(data + len - 4 - step);
+        } else if (len) {
+            a = ((u64)data[0] << 16) | ((u64)data[len >> 1] << 8) | data[len - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        const u8* ptr  = data;
+        usize     left = len;
+
+        if (left > 48) {
+            u64 seed1 = seed, seed2 = seed;
+            do {
+                seed  = InternTable__Mix(InternTable__Read64(ptr) ^ k1, InternTable__Read64(ptr + 8) ^ seed);
+                seed1 = InternTable__Mix(InternTable__Read64(ptr + 16) ^ k2, InternTable__Read64(ptr + 24) ^ seed1);
+                seed2 = InternTable__Mix(InternTable__Read64(ptr + 32) ^ k3, InternTable__Read64(ptr + 40) ^ seed2);
+                ptr  += 48;
+                left -= 48;
+            } while (left > 48);
+            seed ^= seed1 ^ seed2;
+        }
+
+        while (left > 16) {
+            seed  = InternTable__Mix(InternTable__Read64(ptr) ^ k1, InternTable__Read64(ptr + 8) ^ seed);
+            ptr  += 16;
+            left -= 16;
+        }
+
+        a = InternTable__Read64(ptr + left - 16);
+        b = InternTable__Read64(ptr + left - 8);
+    }
+
+    u128 product = (u128)(a ^ k1) * (b ^ seed);
+    return InternTable__Mix((u64)product ^ k0 ^ len, (u64)(product >> 64) ^ k1);
+}
+
+static inline u32 InternTable__Tag(u64 hash)
+{
+    return (u32)(hash >> 32) | 1;
+}
+
+// lock-free probe, NULL if the bytes aren't in `slots`
+static inline const String* InternTable__Probe(const InternTableSlots* slots, u64 hash, const void* data, usize len)
+{
+    u32 tag = InternTable__Tag(hash);
+
+    for (usize ii = hash & slots->mask;; ii = (ii + 1) & slots->mask) {
+        u32 seen = __atomic_load_n(&slots->tags[ii], __ATOMIC_ACQUIRE);
+        if (!seen) return NULL;
+        if (seen != tag) continue;
+
+        const String* str = __atomic_load_n(&slots->strings[ii], __ATOMIC_RELAXED);
+        if (str->len == len && !memcmp(str->at, data, len)) return str;
+    }
+}
+
+// with the lock held, `slots` isn't full
+static inline void InternTable__Place(InternTableSlots* slots, u64 hash, const String* str)
+{
+    usize ii = hash & slots->mask;
+    while (slots->tags[ii]) ii = (ii + 1) & slots->mask;
+
+    __atomic_store_n(&slots->strings[ii], str, __ATOMIC_RELAXED);
+    __atomic_store_n(&slots->tags[ii], InternTable__Tag(hash), __ATOMIC_RELEASE);
+}
+
+SYM_WEAK
+InternTableSlots* InternTable__NewSlots(InternTable* self, usize capacity)
+{
+    usize size = sizeof(InternTableSlots) + capacity * (sizeof(u32) + sizeof(const String*));
+
+    InternTableSlots* slots = MemoryArena_ZAlignedAlloc(&self->arena, TARGET_CACHE_LINE_SIZE, size);
+    if (!slots) return NULL;
+
+    slots->mask    = capacity - 1;
+    slots->strings = (const String**)(slots + 1);
+    slots->tags    = (u32*)(slots->strings + capacity);
+
+    return slots;
+}
+
+SYM_WEAK
+bool InternTable_New(InternTable* self, usize max_size)
+{
+    if (!MemoryArena_New(&self->arena, max_size)) return false;
+
+    self->lock  = (Mutex)MUTEX_INIT;
+    self->count = 0;
+    self->slots = InternTable__NewSlots(self, INTERN_TABLE_MIN_SLOTS);
+    if (!self->slots) {
+        MemoryArena_Delete(&self->arena);
+        return false;
+    }
+
+    return true;
+}
+
+SYM_WEAK
+void InternTable_Delete(InternTable* self)
+{
+    MemoryArena_Delete(&self->arena);
+
+    self->slots = NULL;
+    self->count = 0;
+}
+
+// with the lock held, doubles the slot array
+SYM_WEAK
+bool InternTable__Grow(InternTable* self)
+{
+    InternTableSlots* old   = self->slots;
+    InternTableSlots* slots = InternTable__NewSlots(self, (old->mask + 1) * 2);
+    if (!slots) return false;
+
+    for (usize ii = 0; ii <= old->mask; ii++) {
+        const String* str = old->strings[ii];
+        if (old->tags[ii]) InternTable__Place(slots, InternTable__Hash((const u8*)str->at, str->len), str);
+    }
+
+    __atomic_store_n(&self->slots, slots, __ATOMIC_RELEASE);
+    return true;
+}
+
+SYM_WEAK ATTR(noinline)
+const String* InternTable__Insert(InternTable* self, u64 hash, const void* data, usize len)
+{
+    Mutex_Lock(&self->lock);
+
+    // somebody may have inserted it (or grown the table) since the lock-free probe
+    const String* str = InternTable__Probe(self->slots, hash, data, len);
+    if (str) goto done;
+
+    // kept at most 3/4 full so probes stay short and always find an empty slot
+    if ((self->count + 1) * 4 > (self->slots->mask + 1) * 3 && !InternTable__Grow(self)) goto done;
+
+    String* copy = MemoryArena_UAlignedAlloc(&self->arena, _Alignof(String), sizeof(String) + len + 1);
+    if (!copy) goto done;
+
+    copy->len = len;
+    memcpy((char*)copy->at, data, len);
+    ((char*)copy->at)[len] = '\0';
+
+    InternTable__Place(self->slots, hash, copy);
+    __atomic_store_n(&self->count, self->count + 1, __ATOMIC_RELAXED);
+    str = copy;
+
+done:
+    Mutex_Unlock(&self->lock);
+    return str;
+}
+
+SYM_WEAK
+const String* InternTable_Intern(InternTable* self, const void* data, usize len)
+{
+    u64 hash = InternTable__Hash(data, len);
+
+    const String* str = InternTable__Probe(__atomic_load_n(&self->slots, __ATOMIC_ACQUIRE), hash, data, len);
+    if (likely(str)) return str;
+
+    return InternTable__Insert(self, hash, data, len);
+}
+
+SYM_WEAK
+const String* InternTable_InternString(InternTable* self, const String* str)
+{
+    return InternTable_Intern(self, str->at, str->len);
+}
+
+SYM_WEAK
+const String* InternTable_InternView(InternTable* self, StringView sv)
+{
+    return InternTable_Intern(self, sv.at, sv.len);
+}
+
+SYM_WEAK
+const String* InternTable_Find(InternTable* self, const void* data, usize len)
+{
+    return InternTable__Probe(__atomic_load_n(&self->slots, __ATOMIC_ACQUIRE), InternTable__Hash(data, len), data, len);
+}
+
+SYM_WEAK
+usize InternTable_Count(InternTable* self)
+{
+    return __atomic_load_n(&self->count, __ATOMIC_RELAXED);
+}
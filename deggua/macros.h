@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include <deggua/target.h>
 #include <deggua/logging.h>
@@ -44,6 +45,15 @@
 # error "Unsupported"
 #endif
 
+// spin-wait hint, use in busy loops polling memory written by other threads
+#if TARGET_ARCH == TARGET_ARCH_I386 || TARGET_ARCH == TARGET_ARCH_AMD64
+#define CPU_RELAX() __builtin_ia32_pause()
+#elif TARGET_ARCH == TARGET_ARCH_ARM64
+#define CPU_RELAX() asm volatile("yield" ::: "memory")
+#else
+#define CPU_RELAX() asm volatile("" ::: "memory")
+#endif
+
 #define ABORT(msg, ...)               \
     do {                              \
         LOG_FATAL(                    \
@@ -74,6 +84,39 @@
 
 #define ATTR(...) __attribute__((__VA_ARGS__))
 
+// allocator used by the containers, define these before including any deggua header to replace it
+// (e.g. with Heap_Alloc/Heap_Realloc/Heap_Free from heap.h)
+#ifndef MALLOC
+# define MALLOC(size) malloc(size)
+#endif
+
+#ifndef REALLOC
+# define REALLOC(ptr, size) realloc((ptr), (size))
+#endif
+
+#ifndef FREE
+# define FREE(ptr) free(ptr)
+#endif
+
+// over-aligned blocks through MALLOC/FREE (`alignment` a power of 2, at least MALLOC's own and at most 32 KiB), the
+// offset back to the underlying block is kept in the 2 bytes below the returned pointer
+#define ALIGNED_MALLOC(alignment, size) ({                                                          \
+    size_t am_align_ = (alignment);                                                                 \
+    char*  am_base_  = MALLOC((size) + am_align_);                                                  \
+    char*  am_ptr_   = NULL;                                                                        \
+    if (am_base_) {                                                                                 \
+        am_ptr_ = (char*)(((uintptr_t)am_base_ + am_align_) & ~(uintptr_t)(am_align_ - 1));         \
+        ((unsigned short*)am_ptr_)[-1] = (unsigned short)(am_ptr_ - am_base_);                      \
+    }                                                                                               \
+    (void*)am_ptr_;                                                                                 \
+})
+
+#define ALIGNED_FREE(ptr)                                                            \
+    do {                                                                             \
+        char* af_ptr_ = (char*)(ptr);                                                \
+        if (af_ptr_) FREE(af_ptr_ - ((unsigned short*)af_ptr_)[-1]);                 \
+    } while (0)
+
 #define UNUSED(x) ((void)(x))
 
 #if TARGET_OS == TARGET_OS_WINDOWS
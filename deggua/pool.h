@@ -0,0 +1,249 @@
+#pragma once
+
+#include <string.h>
+
+#include <deggua/types.h>
+#include <deggua/arena.h>
+
+typedef struct MemoryPoolSlot {
+    struct MemoryPoolSlot* next;
+} MemoryPoolSlot;
+
+typedef struct {
+    MemoryArena*    arena;      // arena the slots are carved from
+    usize           slot_size;  // size of each slot (at least a pointer, multiple of slot_align)
+    usize           slot_align; // alignment of each slot
+    MemoryPoolSlot* free_list;  // intrusive list of freed slots
+    u64             epoch;      // arena epoch the free list belongs to
+    u32             lock;       // guards the pool while magazines refill/flush
+} MemoryPool;
+
+#define MEMORY_POOL_MAGAZINE_SIZE (32)
+
+// per-thread stack of slots, amortizes the pool lock over MEMORY_POOL_MAGAZINE_SIZE / 2 allocations
+typedef struct {
+    MemoryPool* pool;
+    u64         epoch;
+    usize       count;
+    void*       slots[MEMORY_POOL_MAGAZINE_SIZE];
+} MemoryPoolMagazine;
+
+/* --- Pool Management --- */
+// Slots live until they're freed or the arena is reset, any reset/release/restore of the arena discards the
+// pool's free list (slots carved before a checkpoint are leaked until the arena is reset).
+
+bool MemoryPool_New(MemoryPool* pool, MemoryArena* arena, usize slot_size, usize slot_align); // Initializes a pool of `slot_size` byte slots carved from `arena`
+void MemoryPool_Reset(MemoryPool* pool);                                                     // Forgets every free slot, use after resetting the arena the pool allocates from
+
+/* --- Pool Allocation (single threaded) --- */
+
+void* MemoryPool_UAlloc(MemoryPool* pool);          // Allocate a slot (uninitialized)
+void* MemoryPool_ZAlloc(MemoryPool* pool);          // Allocate a slot (zero filled)
+void  MemoryPool_Free(MemoryPool* pool, void* ptr); // Return a slot to the pool
+
+/* --- Magazine Allocation (thread safe) --- */
+// Each thread owns its magazine, the pool is shared. The arena is accessed with the atomic allocators so it
+// can also be shared with other MemoryArena_Atomic* users. Don't mix with the single threaded API.
+
+void  MemoryPoolMagazine_New(MemoryPoolMagazine* mag, MemoryPool* pool); // Initializes an empty magazine for `pool`
+void* MemoryPoolMagazine_UAlloc(MemoryPoolMagazine* mag);                // Allocate a slot (uninitialized)
+void* MemoryPoolMagazine_ZAlloc(MemoryPoolMagazine* mag);                // Allocate a slot (zero filled)
+void  MemoryPoolMagazine_Free(MemoryPoolMagazine* mag, void* ptr);       // Return a slot, may be freed by any thread's magazine
+void  MemoryPoolMagazine_Flush(MemoryPoolMagazine* mag);                 // Return every cached slot to the pool (e.g. on thread exit)
+
+/* --- Implementation --- */
+
+SYM_WEAK
+bool MemoryPool_New(MemoryPool* pool, MemoryArena* arena, usize slot_size, usize slot_align)
+{
+    slot_align = max(slot_align, _Alignof(MemoryPoolSlot));
+    slot_size  = alignp2_64(max(slot_size, sizeof(MemoryPoolSlot)), slot_align);
+
+    pool->arena      = arena;
+    pool->slot_size  = slot_size;
+    pool->slot_align = slot_align;
+    pool->free_list  = NULL;
+    pool->epoch      = __atomic_load_n(&arena->epoch, __ATOMIC_RELAXED);
+    pool->lock       = 0;
+
+    return true;
+}
+
+SYM_WEAK
+void MemoryPool_Reset(MemoryPool* pool)
+{
+    pool->free_list = NULL;
+    pool->epoch     = __atomic_load_n(&pool->arena->epoch, __ATOMIC_RELAXED);
+}
+
+static inline void MemoryPool__Validate(MemoryPool* pool)
+{
+    if (unlikely(pool->epoch != __atomic_load_n(&pool->arena->epoch, __ATOMIC_RELAXED))) {
+        MemoryPool_Reset(pool);
+    }
+}
+
+SYM_WEAK
+void* MemoryPool_UAlloc(MemoryPool* pool)
+{
+    MemoryPool__Validate(pool);
+
+    MemoryPoolSlot* slot = pool->free_list;
+    if (likely(slot)) {
+        pool->free_list = slot->next;
+        return slot;
+    }
+
+    return MemoryArena_UAlignedAlloc(pool->arena, pool->slot_align, pool->slot_size);
+}
+
+SYM_WEAK
+void* MemoryPool_ZAlloc(MemoryPool* pool)
+{
+    void* ptr = MemoryPool_UAlloc(pool);
+    if (ptr) memset(ptr, 0x00, pool->slot_size);
+
+    return ptr;
+}
+
+SYM_WEAK
+void MemoryPool_Free(MemoryPool* pool, void* ptr)
+{
+    if (!ptr) return;
+
+    MemoryPool__Validate(pool);
+
+    MemoryPoolSlot* slot = ptr;
+    slot->next           = pool->free_list;
+    pool->free_list      = slot;
+}
+
+static inline void MemoryPool__Lock(MemoryPool* pool)
+{
+    while (__atomic_exchange_n(&pool->lock, 1, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(&pool->lock, __ATOMIC_RELAXED)) {
+            CPU_RELAX();
+        }
+    }
+}
+
+static inline void MemoryPool__Unlock(MemoryPool* pool)
+{
+    __atomic_store_n(&pool->lock, 0, __ATOMIC_RELEASE);
+}
+
+SYM_WEAK
+void MemoryPoolMagazine_New(MemoryPoolMagazine* mag, MemoryPool* pool)
+{
+    mag->pool  = pool;
+    mag->epoch = __atomic_load_n(&pool->arena->epoch, __ATOMIC_RELAXED);
+    mag->count = 0;
+}
+
+// fills the magazine halfway from the pool's free list, carving a fresh batch from the arena if it's empty
+SYM_WEAK
+bool MemoryPoolMagazine__Refill(MemoryPoolMagazine* mag)
+{
+    MemoryPool* pool = mag->pool;
+    usize       want = MEMORY_POOL_MAGAZINE_SIZE / 2;
+
+    MemoryPool__Lock(pool);
+    MemoryPool__Validate(pool);
+
+    while (mag->count < want && pool->free_list) {
+        MemoryPoolSlot* slot     = pool->free_list;
+        pool->free_list          = slot->next;
+        mag->slots[mag->count++] = slot;
+    }
+
+    MemoryPool__Unlock(pool);
+
+    if (mag->count) return true;
+
+    char* batch = MemoryArena_AtomicUAlignedAlloc(pool->arena, pool->slot_align, want * pool->slot_size);
+    if (!batch) return false;
+
+    for (usize ii = 0; ii < want; ii++) {
+        mag->slots[mag->count++] = batch + (want - 1 - ii) * pool->slot_size;
+    }
+
+    return true;
+}
+
+// returns the oldest `count` slots of the magazine to the pool
+SYM_WEAK
+void MemoryPoolMagazine__Drain(MemoryPoolMagazine* mag, usize count)
+{
+    if (!count) return;
+
+    // link the slots up front so the lock is only held for the splice
+    for (usize ii = 0; ii + 1 < count; ii++) {
+        ((MemoryPoolSlot*)mag->slots[ii])->next = mag->slots[ii + 1];
+    }
+
+    MemoryPool*     pool  = mag->pool;
+    MemoryPoolSlot* first = mag->slots[0];
+    MemoryPoolSlot* last  = mag->slots[count - 1];
+
+    MemoryPool__Lock(pool);
+    MemoryPool__Validate(pool);
+
+    last->next      = pool->free_list;
+    pool->free_list = first;
+
+    MemoryPool__Unlock(pool);
+
+    memmove(&mag->slots[0], &mag->slots[count], (mag->count - count) * sizeof(mag->slots[0]));
+    mag->count -= count;
+}
+
+static inline void MemoryPoolMagazine__Validate(MemoryPoolMagazine* mag)
+{
+    u64 epoch = __atomic_load_n(&mag->pool->arena->epoch, __ATOMIC_RELAXED);
+    if (unlikely(mag->epoch != epoch)) {
+        mag->count = 0;
+        mag->epoch = epoch;
+    }
+}
+
+SYM_WEAK
+void* MemoryPoolMagazine_UAlloc(MemoryPoolMagazine* mag)
+{
+    MemoryPoolMagazine__Validate(mag);
+
+    if (unlikely(!mag->count)) {
+        if (!MemoryPoolMagazine__Refill(mag)) return NULL;
+    }
+
+    return mag->slots[--mag->count];
+}
+
+SYM_WEAK
+void* MemoryPoolMagazine_ZAlloc(MemoryPoolMagazine* mag)
+{
+    void* ptr = MemoryPoolMagazine_UAlloc(mag);
+    if (ptr) memset(ptr, 0x00, mag->pool->slot_size);
+
+    return ptr;
+}
+
+SYM_WEAK
+void MemoryPoolMagazine_Free(MemoryPoolMagazine* mag, void* ptr)
+{
+    if (!ptr) return;
+
+    MemoryPoolMagazine__Validate(mag);
+
+    if (unlikely(mag->count == MEMORY_POOL_MAGAZINE_SIZE)) {
+        MemoryPoolMagazine__Drain(mag, MEMORY_POOL_MAGAZINE_SIZE / 2);
+    }
+
+    mag->slots[mag->count++] = ptr;
+}
+
+SYM_WEAK
+void MemoryPoolMagazine_Flush(MemoryPoolMagazine* mag)
+{
+    MemoryPoolMagazine__Validate(mag);
+    MemoryPoolMagazine__Drain(mag, mag->count);
+}
@@ -0,0 +1,319 @@
+#pragma once
+
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+
+#include <deggua/types.h>
+#include <deggua/pool.h>
+
+// Safe memory reclamation for lock-free structures. Readers wrap their accesses in Epoch_Enter/Epoch_Exit, writers
+// unlink a node and Epoch_Retire it, the node is freed once the global epoch moved twice past the retire, at which
+// point every reader that could have seen it has left its critical section. Epochs stop advancing while any reader
+// stays inside, so a reader holding on to a node for long should move it to a hazard pointer (Epoch_Hold) and exit,
+// nodes published in a hazard slot are skipped when reclaiming until the slot is released.
+//
+// Retired nodes are kept per thread and freed by the thread that retired them, which is what lets them go straight
+// back into that thread's MemoryPoolMagazine.
+
+#define EPOCH_HAZARDS          (4)  // hazard pointer slots per thread
+#define EPOCH_RETIRE_THRESHOLD (64) // retired nodes a thread collects before it tries to reclaim
+
+typedef struct {
+    void* ptr;
+    void  (*free)(void* ctx, void* ptr);
+    void* ctx;
+    u64   epoch; // global epoch when retired
+} EpochRetired;
+
+#define T EpochRetired
+#include <deggua/generic/vector.h>
+
+struct EpochDomain;
+
+typedef struct EpochThread {
+    u64                 local ATTR(aligned(TARGET_CACHE_LINE_SIZE)); // (epoch << 1) | 1 inside a critical section, 0 outside
+    void*               hazards[EPOCH_HAZARDS];
+    struct EpochThread* next;    // registry, records are never unlinked
+    struct EpochDomain* domain;
+    u32                 in_use;  // cleared by Epoch_Unregister so the record can be reused
+    u32                 nesting; // Epoch_Enter depth
+    Vector(EpochRetired) retired;
+} EpochThread;
+
+typedef struct EpochDomain {
+    u64          epoch ATTR(aligned(TARGET_CACHE_LINE_SIZE));
+    EpochThread* threads;
+} EpochDomain;
+
+#define EPOCH_DOMAIN_INIT {0}
+
+/* --- Domains --- */
+// Structures sharing a domain share the epoch, one domain for the whole program is fine unless a structure's readers
+// routinely stay inside for long.
+
+void EpochDomain_New(EpochDomain* self);
+void EpochDomain_Delete(EpochDomain* self); // every thread must have unregistered
+
+EpochThread* Epoch_Register(EpochDomain* domain); // Per thread record, NULL if out of memory
+void         Epoch_Unregister(EpochThread* self); // Waits until everything the thread retired is freed, outside of critical sections
+
+/* --- Readers --- */
+
+static inline void Epoch_Enter(EpochThread* self); // Critical sections nest
+static inline void Epoch_Exit(EpochThread* self);
+
+// hazard pointers: Protect loads `*src` and keeps it alive without a critical section, Hold does the same for a node
+// already reached inside one (and must be called before Epoch_Exit)
+static inline void* Epoch_Protect(EpochThread* self, usize slot, void* const* src);
+static inline void  Epoch_Hold(EpochThread* self, usize slot, void* ptr);
+static inline void  Epoch_Release(EpochThread* self, usize slot);
+
+/* --- Writers --- */
+
+bool Epoch_Retire(EpochThread* self, void* ptr, void (*free)(void* ctx, void* ptr), void* ctx); // `free(ctx, ptr)` once no reader can hold `ptr`, false if out of memory
+bool Epoch_RetireToMagazine(EpochThread* self, MemoryPoolMagazine* mag, void* ptr);            // The thread's own magazine, freed on this thread
+void Epoch_Reclaim(EpochThread* self);                                                          // Try to advance the epoch and free what's safe now
+void Epoch_Barrier(EpochThread* self);                                                          // Block until everything retired so far is freed, not from inside a critical section
+
+/* --- Implementation --- */
+
+SYM_WEAK
+void EpochDomain_New(EpochDomain* self)
+{
+    self->epoch   = 0;
+    self->threads = NULL;
+}
+
+SYM_WEAK
+void EpochDomain_Delete(EpochDomain* self)
+{
+    EpochThread* thread = self->threads;
+    while (thread) {
+        EpochThread* next = thread->next;
+
+        Vector_Delete(EpochRetired)(&thread->retired);
+        ALIGNED_FREE(thread);
+
+        thread = next;
+    }
+
+    self->threads = NULL;
+}
+
+SYM_WEAK
+EpochThread* Epoch_Register(EpochDomain* domain)
+{
+    // reuse the record of a thread that left
+    for (EpochThread* thread = __atomic_load_n(&domain->threads, __ATOMIC_ACQUIRE); thread; thread = thread->next) {
+        u32 unused = 0;
+        if (!__atomic_load_n(&thread->in_use, __ATOMIC_RELAXED)) {
+            if (__atomic_compare_exchange_n(&thread->in_use, &unused, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) return thread;
+        }
+    }
+
+    EpochThread* thread = ALIGNED_MALLOC(TARGET_CACHE_LINE_SIZE, sizeof(EpochThread));
+    if (!thread) return NULL;
+
+    memset(thread, 0x00, sizeof(*thread));
+    if (!Vector_New(EpochRetired)(&thread->retired, EPOCH_RETIRE_THRESHOLD)) {
+        ALIGNED_FREE(thread);
+        return NULL;
+    }
+
+    thread->domain = domain;
+    thread->in_use = 1;
+
+    EpochThread* head = __atomic_load_n(&domain->threads, __ATOMIC_RELAXED);
+    do {
+        thread->next = head;
+    } while (!__atomic_compare_exchange_n(&domain->threads, &head, thread, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+    return thread;
+}
+
+SYM_WEAK
+void Epoch_Unregister(EpochThread* self)
+{
+    Epoch_Barrier(self);
+
+    for (usize ii = 0; ii < EPOCH_HAZARDS; ii++) {
+        Epoch_Release(self, ii);
+    }
+
+    self->nesting = 0;
+    __atomic_store_n(&self->local, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&self->in_use, 0, __ATOMIC_RELEASE);
+}
+
+static inline void Epoch_Enter(EpochThread* self)
+{
+    if (self->nesting++) return;
+
+    // the announcement has to be visible before any shared pointer is read, hence seq_cst (a full barrier)
+    u64 epoch = __atomic_load_n(&self->domain->epoch, __ATOMIC_RELAXED);
+    __atomic_store_n(&self->local, (epoch << 1) | 1, __ATOMIC_SEQ_CST);
+}
+
+static inline void Epoch_Exit(EpochThread* self)
+{
+    if (--self->nesting) return;
+
+    __atomic_store_n(&self->local, 0, __ATOMIC_RELEASE);
+}
+
+static inline void* Epoch_Protect(EpochThread* self, usize slot, void* const* src)
+{
+    void* ptr = __atomic_load_n(src, __ATOMIC_ACQUIRE);
+
+    for (;;) {
+        // publish, then check the node is still reachable, a reclaimer that missed the hazard unlinked it before that
+        __atomic_store_n(&self->hazards[slot], ptr, __ATOMIC_SEQ_CST);
+
+        void* again = __atomic_load_n(src, __ATOMIC_ACQUIRE);
+        if (again == ptr) return ptr;
+
+        ptr = again;
+    }
+}
+
+static inline void Epoch_Hold(EpochThread* self, usize slot, void* ptr)
+{
+    __atomic_store_n(&self->hazards[slot], ptr, __ATOMIC_SEQ_CST);
+}
+
+static inline void Epoch_Release(EpochThread* self, usize slot)
+{
+    __atomic_store_n(&self->hazards[slot], NULL, __ATOMIC_RELEASE);
+}
+
+// advances the global epoch if every thread inside a critical section has seen the current one, returns the epoch
+SYM_WEAK
+u64 Epoch__TryAdvance(EpochDomain* domain)
+{
+    u64 epoch = __atomic_load_n(&domain->epoch, __ATOMIC_SEQ_CST);
+
+    for (EpochThread* thread = __atomic_load_n(&domain->threads, __ATOMIC_ACQUIRE); thread; thread = thread->next) {
+        u64 local = __atomic_load_n(&thread->local, __ATOMIC_SEQ_CST);
+        if ((local & 1) && (local >> 1) != epoch) return epoch;
+    }
+
+    if (__atomic_compare_exchange_n(&domain->epoch, &epoch, epoch + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) epoch++;
+
+    return epoch;
+}
+
+static int Epoch__ComparePtr(const void* lhs, const void* rhs)
+{
+    uptr a = *(const uptr*)lhs;
+    uptr b = *(const uptr*)rhs;
+
+    return (a > b) - (a < b);
+}
+
+SYM_WEAK
+void Epoch_Reclaim(EpochThread* self)
+{
+    EpochDomain* domain = self->domain;
+    u64          epoch  = Epoch__TryAdvance(domain);
+
+    // retired in order, nodes from two epochs back or older are unreachable for anything but hazard pointers
+    Vector(EpochRetired)* retired = &self->retired;
+
+    usize safe = 0;
+    while (safe < retired->len && retired->at[safe].epoch + 2 <= epoch) safe++;
+    if (!safe) return;
+
+    usize capacity = 0;
+    for (EpochThread* thread = __atomic_load_n(&domain->threads, __ATOMIC_ACQUIRE); thread; thread = thread->next) {
+        capacity += EPOCH_HAZARDS;
+    }
+
+    // snapshot of the published hazards, sorted for lookups. Without memory for it nothing is freed this time.
+    uptr* hazards = MALLOC(capacity * sizeof(uptr));
+    if (!hazards) return;
+
+    // threads registered since the first walk can push the snapshot past its size, a partial snapshot could miss a
+    // hazard so nothing is freed until the next attempt
+    usize count = 0;
+    for (EpochThread* thread = __atomic_load_n(&domain->threads, __ATOMIC_ACQUIRE); thread; thread = thread->next) {
+        for (usize ii = 0; ii < EPOCH_HAZARDS; ii++) {
+            void* ptr = __atomic_load_n(&thread->hazards[ii], __ATOMIC_SEQ_CST);
+            if (!ptr) continue;
+
+            if (count == capacity) {
+                FREE(hazards);
+                return;
+            }
+
+            hazards[count++] = (uptr)ptr;
+        }
+    }
+
+    if (count > 1) qsort(hazards, count, sizeof(uptr), Epoch__ComparePtr);
+
+    // free the unprotected ones, protected ones stay at the front of the list for the next attempt
+    usize kept = 0;
+    for (usize ii = 0; ii < safe; ii++) {
+        EpochRetired* node = &retired->at[ii];
+
+        uptr key = (uptr)node->ptr;
+        if (count && bsearch(&key, hazards, count, sizeof(uptr), Epoch__ComparePtr)) {
+            retired->at[kept++] = *node;
+        } else {
+            node->free(node->ctx, node->ptr);
+        }
+    }
+
+    memmove(&retired->at[kept], &retired->at[safe], (retired->len - safe) * sizeof(EpochRetired));
+    retired->len -= safe - kept;
+
+    FREE(hazards);
+}
+
+SYM_WEAK
+bool Epoch_Retire(EpochThread* self, void* ptr, void (*free)(void* ctx, void* ptr), void* ctx)
+{
+    EpochRetired node = {
+        .ptr   = ptr,
+        .free  = free,
+        .ctx   = ctx,
+        .epoch = __atomic_load_n(&self->domain->epoch, __ATOMIC_SEQ_CST),
+    };
+
+    if (!Vector_Append(EpochRetired)(&self->retired, &node)) return false;
+
+    // while a reader holds the epoch back the list keeps growing, only look again every half threshold
+    if (self->retired.len >= EPOCH_RETIRE_THRESHOLD && self->retired.len % (EPOCH_RETIRE_THRESHOLD / 2) == 0) {
+        Epoch_Reclaim(self);
+    }
+
+    return true;
+}
+
+static void Epoch__FreeToMagazine(void* ctx, void* ptr)
+{
+    MemoryPoolMagazine_Free(ctx, ptr);
+}
+
+SYM_WEAK
+bool Epoch_RetireToMagazine(EpochThread* self, MemoryPoolMagazine* mag, void* ptr)
+{
+    return Epoch_Retire(self, ptr, Epoch__FreeToMagazine, mag);
+}
+
+SYM_WEAK
+void Epoch_Barrier(EpochThread* self)
+{
+    for (usize attempt = 0; self->retired.len; attempt++) {
+        Epoch_Reclaim(self);
+
+        if (self->retired.len) {
+            if (attempt < 16) {
+                CPU_RELAX();
+            } else {
+                sched_yield();
+            }
+        }
+    }
+}
@@ -1,6 +1,18 @@
 #pragma once
 
+#include <errno.h>
+#include <string.h>
+#include <sys/uio.h>
+
+#include <deggua/target.h>
+
+#if TARGET_ARCH == TARGET_ARCH_AMD64
+#    include <immintrin.h>
+#endif
+
 #include <deggua/types.h>
+#include <deggua/bitops.h>
+#include <deggua/arena.h>
 
 typedef struct {
     usize      len;
@@ -26,16 +38,909 @@ const char* String_CStr(String* self);
 bool String_Append(String* self, const String* other);
 bool String_Prepend(String* self, const String* other);
 
-usize String_Find(const String* self, const String* substr);
-usize String_FindFrom(const String* self, const String* substr, usize index);
-usize String_ReverseFind(const String* self, const String* substr);
-usize String_ReverseFindFrom(const String* self, const String* substr, usize index);
+#define STRING_NPOS (USIZE_MAX) // returned by the find functions when there's no match
+
+usize String_Find(const String* self, const String* substr);                         // Index of the first match
+usize String_FindFrom(const String* self, const String* substr, usize index);        // First match at or after `index`
+usize String_ReverseFind(const String* self, const String* substr);                  // Index of the last match
+usize String_ReverseFindFrom(const String* self, const String* substr, usize index); // Last match at or before `index`
 
 bool String_BeginsWith(const String* self, const String* substr);
 bool String_EndsWith(const String* self, const String* substr);
 bool String_Contains(const String* self, const String* substr);
-isize String_Compare(const String* self, const String* other);
-bool String_Equal(const String* self, const String* other);
+isize String_Compare(const String* self, const String* other); // memcmp order, a prefix sorts first
+bool String_Equal(const String* self, const String* other);    // Same pointer is checked first, which is all it takes for interned strings
 
 #define STR_FMT    "%.*s"
 #define STR_ARG(x) ((x)->len), ((x)->at)
+
+/* --- String Views --- */
+
+StringView StringView_Of(const String* str);
+StringView StringView_FromCStr(const char* cstr);
+StringView StringView_Trim(StringView sv); // Without the ASCII whitespace at both ends
+
+// Iterators splitting a view into the pieces between delimiters, the pieces point into the view and nothing is
+// allocated. Delimiters are classified 64 bytes at a time and the positions kept as a bitmask, so short pieces don't
+// rescan anything. Every split yields at least one (maybe empty) piece, "a,,b" splits into "a", "", "b".
+//
+//     StringSplit split;
+//     StringView  field;
+//     StringSplit_New_Fields(&split, line, ',');
+//     while (StringSplit_Next(&split, &field)) { ... }
+
+typedef struct {
+    const char* at;
+    usize       len;
+    usize       pos;   // start of the next piece
+    usize       block; // start of the classified block `mask` refers to
+    usize       next;  // first byte not classified yet
+    u64         mask;  // delimiters in the block at or after `pos`
+    u32         mode;  // STRING_SPLIT__*
+    u8          delim;
+    // nibble tables for delimiter sets, [0] for bytes below 0x80 and [1] for the rest, a byte `b` is a delimiter if
+    // lo[b >> 7][b & 15] & hi[b >> 7][b >> 4] is set
+    u8          lo[2][16] ATTR(aligned(16));
+    u8          hi[2][16] ATTR(aligned(16));
+} StringSplit;
+
+void StringSplit_New(StringSplit* self, StringView sv, char delim);
+void StringSplit_New_Any(StringSplit* self, StringView sv, const char* delims); // Any byte of the NUL terminated `delims` separates pieces
+void StringSplit_New_Lines(StringSplit* self, StringView sv);                   // Lines without their "\n" or "\r\n", no empty piece after a final newline
+void StringSplit_New_Fields(StringSplit* self, StringView sv, char delim);      // Same as StringSplit_New with every piece trimmed
+
+bool StringSplit_Next(StringSplit* self, StringView* piece); // false once every piece was returned
+
+/* --- String Builder --- */
+// Collects a string as a list of StringView pieces instead of growing one buffer, appending or prepending is O(1)
+// and nothing is copied until the result is built or written out. Pieces only reference the caller's bytes, which
+// must stay valid until then, use the *Copy variants for temporaries. Pieces that are adjacent in memory are merged.
+// The piece lists are carved from a MemoryArena and handed back with it.
+
+#define STRING_BUILDER_CHUNK_PIECES (62) // pieces per chunk, sized so a chunk is just under 1 KiB
+
+typedef struct StringBuilderChunk {
+    struct StringBuilderChunk* prev;
+    struct StringBuilderChunk* next;
+    u32                        begin; // used pieces are [begin, end), prepending fills the front chunk downwards
+    u32                        end;
+    StringView                 pieces[STRING_BUILDER_CHUNK_PIECES];
+} StringBuilderChunk;
+
+typedef struct {
+    MemoryArena*        arena;
+    StringBuilderChunk* head;
+    StringBuilderChunk* tail;
+    usize               len; // total bytes
+} StringBuilder;
+
+void StringBuilder_New(StringBuilder* self, MemoryArena* arena);
+void StringBuilder_Clear(StringBuilder* self); // Forgets the pieces, the chunks stay allocated in the arena
+
+bool StringBuilder_Append(StringBuilder* self, StringView sv);                    // false if the arena is out of memory
+bool StringBuilder_Prepend(StringBuilder* self, StringView sv);
+bool StringBuilder_AppendString(StringBuilder* self, const String* str);
+bool StringBuilder_PrependString(StringBuilder* self, const String* str);
+bool StringBuilder_AppendCopy(StringBuilder* self, const void* data, usize len);  // Copies `data` into the arena first
+bool StringBuilder_PrependCopy(StringBuilder* self, const void* data, usize len);
+
+usize   StringBuilder_Length(const StringBuilder* self);
+void    StringBuilder_CopyTo(const StringBuilder* self, char* dst);           // Writes the Length() bytes to `dst`
+String* StringBuilder_Build(const StringBuilder* self, MemoryArena* arena); // NUL terminated String allocated from `arena`, NULL if out of memory
+
+// Writes the pieces with writev, dropping whatever was written from the front of the builder. Returns like
+// Fifo_WriteToFd: the bytes written (stops early when the fd would block), -1 with errno set if nothing could be.
+isize StringBuilder_WriteToFd(StringBuilder* self, int fd);
+
+/* --- Implementation --- */
+
+/* --- Search --- */
+// Short needles are found by comparing the needle's first and last byte against a whole block of candidate positions
+// at once and only verifying the positions where both match, which on real text rarely happens by chance. That's
+// quadratic for a long needle made of common bytes, so from STRING_TWO_WAY_MIN on the forward search switches to
+// Two-Way (Crochemore-Perrin), linear time and constant space.
+
+#define STRING_TWO_WAY_MIN (64) // needle length from which the forward search uses Two-Way
+
+// positions [from, hay_len - needle_len] checked one by one, needle_len >= 1
+static inline usize String__FindScalar(const u8* hay, usize hay_len, const u8* needle, usize needle_len, usize from)
+{
+    usize last = hay_len - needle_len;
+
+    while (from <= last) {
+        const u8* hit = memchr(hay + from, needle[0], last - from + 1);
+        if (!hit) return STRING_NPOS;
+
+        from = hit - hay;
+        if (!memcmp(hit + 1, needle + 1, needle_len - 1)) return from;
+        from++;
+    }
+
+    return STRING_NPOS;
+}
+
+// positions [0, upto) checked from the back, needle_len >= 1
+static inline usize String__ReverseFindScalar(const u8* hay, const u8* needle, usize needle_len, usize upto)
+{
+    while (upto--) {
+        if (hay[upto] == needle[0] && !memcmp(hay + upto + 1, needle + 1, needle_len - 1)) return upto;
+    }
+
+    return STRING_NPOS;
+}
+
+SYM_WEAK
+usize String__FindTwoWay(const u8* hay, usize hay_len, const u8* needle, usize needle_len, usize from)
+{
+    // shift[c] is how far the window moves when `c` is under the needle's last byte, 0 if `c` is the last byte
+    usize shift[256];
+    for (usize ii = 0; ii < 256; ii++) {
+        shift[ii] = needle_len;
+    }
+    for (usize ii = 0; ii < needle_len; ii++) {
+        shift[needle[ii]] = needle_len - ii - 1;
+    }
+
+    // critical factorization: the longer of the maximal suffixes under both byte orders
+    usize split[2], period[2];
+    for (usize order = 0; order < 2; order++) {
+        usize ip = USIZE_MAX, jp = 0, kk = 1, pp = 1;
+
+        while (jp + kk < needle_len) {
+            u8 a = needle[ip + kk];
+            u8 b = needle[jp + kk];
+
+            if (a == b) {
+                if (kk == pp) {
+                    jp += pp;
+                    kk = 1;
+                } else {
+                    kk++;
+                }
+            } else if ((a > b) != order) {
+                jp += kk;
+                kk = 1;
+                pp = jp - ip;
+            } else {
+                ip = jp++;
+                kk = pp = 1;
+            }
+        }
+
+        split[order]  = ip;
+        period[order] = pp;
+    }
+
+    usize ms = split[0], period_len = period[0];
+    if (split[1] + 1 > split[0] + 1) {
+        ms         = split[1];
+        period_len = period[1];
+    }
+
+    // a periodic needle remembers how much of its prefix already matched after a shift by the period
+    usize mem0;
+    if (memcmp(needle, needle + period_len, ms + 1)) {
+        mem0       = 0;
+        period_len = max(ms + 1, needle_len - ms - 1) + 1;
+    } else {
+        mem0 = needle_len - period_len;
+    }
+
+    usize     mem = 0;
+    const u8* win = hay + from;
+    const u8* end = hay + hay_len;
+
+    while ((usize)(end - win) >= needle_len) {
+        usize skip = shift[win[needle_len - 1]];
+        if (skip) {
+            // a short shift inside a remembered period can't line up with a match before the period is used up
+            if (mem0 && mem && skip < period_len) skip = needle_len - period_len;
+            win += skip;
+            mem  = 0;
+            continue;
+        }
+
+        usize kk = max(ms + 1, mem);
+        while (kk < needle_len && needle[kk] == win[kk]) kk++;
+        if (kk < needle_len) {
+            win += kk - ms;
+            mem  = 0;
+            continue;
+        }
+
+        kk = ms + 1;
+        while (kk > mem && needle[kk - 1] == win[kk - 1]) kk--;
+        if (kk <= mem) return win - hay;
+
+        win += period_len;
+        mem  = mem0;
+    }
+
+    return STRING_NPOS;
+}
+
+#if TARGET_ARCH == TARGET_ARCH_AMD64
+
+// SSE2 is part of the AMD64 baseline, so this path needs no check
+SYM_WEAK
+usize String__FindSse2(const u8* hay, usize hay_len, const u8* needle, usize needle_len, usize from)
+{
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last  = _mm_set1_epi8(needle[needle_len - 1]);
+
+    usize ii = from;
+    for (; ii + needle_len - 1 + 16 <= hay_len; ii += 16) {
+        __m128i block_first = _mm_loadu_si128((const __m128i*)(hay + ii));
+        __m128i block_last  = _mm_loadu_si128((const __m128i*)(hay + ii + needle_len - 1));
+
+        u32 mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last)));
+        while (mask) {
+            usize pos = ii + ctz_32(mask);
+            if (!memcmp(hay + pos + 1, needle + 1, needle_len - 2)) return pos;
+            mask &= mask - 1;
+        }
+    }
+
+    return String__FindScalar(hay, hay_len, needle, needle_len, ii);
+}
+
+SYM_WEAK
+usize String__ReverseFindSse2(const u8* hay, const u8* needle, usize needle_len, usize upto)
+{
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last  = _mm_set1_epi8(needle[needle_len - 1]);
+
+    for (; upto >= 16; upto -= 16) {
+        usize   base        = upto - 16;
+        __m128i block_first = _mm_loadu_si128((const __m128i*)(hay + base));
+        __m128i block_last  = _mm_loadu_si128((const __m128i*)(hay + base + needle_len - 1));
+
+        u32 mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last)));
+        while (mask) {
+            usize bit = 31 - clz_32(mask);
+            if (!memcmp(hay + base + bit + 1, needle + 1, needle_len - 2)) return base + bit;
+            mask ^= U32_C(1) << bit;
+        }
+    }
+
+    return String__ReverseFindScalar(hay, needle, needle_len, upto);
+}
+
+SYM_WEAK ATTR(target("avx2"))
+usize String__FindAvx2(const u8* hay, usize hay_len, const u8* needle, usize needle_len, usize from)
+{
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last  = _mm256_set1_epi8(needle[needle_len - 1]);
+
+    usize ii = from;
+    for (; ii + needle_len - 1 + 32 <= hay_len; ii += 32) {
+        __m256i block_first = _mm256_loadu_si256((const __m256i*)(hay + ii));
+        __m256i block_last  = _mm256_loadu_si256((const __m256i*)(hay + ii + needle_len - 1));
+
+        u32 mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(block_first, first), _mm256_cmpeq_epi8(block_last, last)));
+        while (mask) {
+            usize pos = ii + ctz_32(mask);
+            if (!memcmp(hay + pos + 1, needle + 1, needle_len - 2)) return pos;
+            mask &= mask - 1;
+        }
+    }
+
+    return String__FindSse2(hay, hay_len, needle, needle_len, ii);
+}
+
+SYM_WEAK ATTR(target("avx2"))
+usize String__ReverseFindAvx2(const u8* hay, const u8* needle, usize needle_len, usize upto)
+{
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last  = _mm256_set1_epi8(needle[needle_len - 1]);
+
+    for (; upto >= 32; upto -= 32) {
+        usize   base        = upto - 32;
+        __m256i block_first = _mm256_loadu_si256((const __m256i*)(hay + base));
+        __m256i block_last  = _mm256_loadu_si256((const __m256i*)(hay + base + needle_len - 1));
+
+        u32 mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(block_first, first), _mm256_cmpeq_epi8(block_last, last)));
+        while (mask) {
+            usize bit = 31 - clz_32(mask);
+            if (!memcmp(hay + base + bit + 1, needle + 1, needle_len - 2)) return base + bit;
+            mask ^= U32_C(1) << bit;
+        }
+    }
+
+    return String__ReverseFindSse2(hay, needle, needle_len, upto);
+}
+
+#define STRING__SIMD_SSE2  (1)
+#define STRING__SIMD_SSSE3 (2)
+#define STRING__SIMD_AVX2  (3)
+
+// cached __builtin_cpu_supports, 0 until the first call, then the best STRING__SIMD_* the CPU has
+SYM_WEAK i32 String__simd_level;
+
+static inline i32 String__SimdLevel(void)
+{
+    i32 level = __atomic_load_n(&String__simd_level, __ATOMIC_RELAXED);
+    if (unlikely(!level)) {
+        level = __builtin_cpu_supports("avx2")  ? STRING__SIMD_AVX2
+              : __builtin_cpu_supports("ssse3") ? STRING__SIMD_SSSE3
+                                                : STRING__SIMD_SSE2;
+        __atomic_store_n(&String__simd_level, level, __ATOMIC_RELAXED);
+    }
+
+    return level;
+}
+
+#endif
+
+// first match of `needle` in `hay` at or after `from`
+static inline usize String__Search(const u8* hay, usize hay_len, const u8* needle, usize needle_len, usize from)
+{
+    if (from > hay_len || needle_len > hay_len - from) return STRING_NPOS;
+    if (needle_len == 0) return from;
+
+    if (needle_len == 1) {
+        const u8* hit = memchr(hay + from, needle[0], hay_len - from);
+        return hit ? (usize)(hit - hay) : STRING_NPOS;
+    }
+
+    if (needle_len >= STRING_TWO_WAY_MIN) return String__FindTwoWay(hay, hay_len, needle, needle_len, from);
+
+#if TARGET_ARCH == TARGET_ARCH_AMD64
+    if (String__SimdLevel() >= STRING__SIMD_AVX2) return String__FindAvx2(hay, hay_len, needle, needle_len, from);
+    return String__FindSse2(hay, hay_len, needle, needle_len, from);
+#else
+    return String__FindScalar(hay, hay_len, needle, needle_len, from);
+#endif
+}
+
+// last match of `needle` in `hay` at or before `index`
+static inline usize String__ReverseSearch(const u8* hay, usize hay_len, const u8* needle, usize needle_len, usize index)
+{
+    if (needle_len > hay_len) return STRING_NPOS;
+
+    usize last = min(index, hay_len - needle_len);
+    if (needle_len == 0) return last;
+
+#if TARGET_ARCH == TARGET_ARCH_AMD64
+    if (needle_len > 1) {
+        if (String__SimdLevel() >= STRING__SIMD_AVX2) return String__ReverseFindAvx2(hay, needle, needle_len, last + 1);
+        return String__ReverseFindSse2(hay, needle, needle_len, last + 1);
+    }
+#endif
+
+    return String__ReverseFindScalar(hay, needle, needle_len, last + 1);
+}
+
+SYM_WEAK
+usize String_Find(const String* self, const String* substr)
+{
+    return String__Search((const u8*)self->at, self->len, (const u8*)substr->at, substr->len, 0);
+}
+
+SYM_WEAK
+usize String_FindFrom(const String* self, const String* substr, usize index)
+{
+    return String__Search((const u8*)self->at, self->len, (const u8*)substr->at, substr->len, index);
+}
+
+SYM_WEAK
+usize String_ReverseFind(const String* self, const String* substr)
+{
+    return String__ReverseSearch((const u8*)self->at, self->len, (const u8*)substr->at, substr->len, STRING_NPOS);
+}
+
+SYM_WEAK
+usize String_ReverseFindFrom(const String* self, const String* substr, usize index)
+{
+    return String__ReverseSearch((const u8*)self->at, self->len, (const u8*)substr->at, substr->len, index);
+}
+
+SYM_WEAK
+bool String_Contains(const String* self, const String* substr)
+{
+    return String_Find(self, substr) != STRING_NPOS;
+}
+
+/* --- Comparison --- */
+
+SYM_WEAK
+isize String_Compare(const String* self, const String* other)
+{
+    if (self == other) return 0;
+
+    int cmp = memcmp(self->at, other->at, min(self->len, other->len));
+    if (cmp) return cmp;
+
+    return (self->len > other->len) - (self->len < other->len);
+}
+
+SYM_WEAK
+bool String_Equal(const String* self, const String* other)
+{
+    return self == other || (self->len == other->len && !memcmp(self->at, other->at, self->len));
+}
+
+/* --- String Views --- */
+
+#define STRING_SPLIT__BYTE  (1u << 0) // single delimiter `delim`
+#define STRING_SPLIT__SET   (1u << 1) // delimiter set in the nibble tables
+#define STRING_SPLIT__LINES (1u << 2) // strip '\r' before the delimiter, no trailing empty piece
+#define STRING_SPLIT__TRIM  (1u << 3) // trim every piece
+#define STRING_SPLIT__HIGH  (1u << 4) // the set has bytes >= 0x80, the second pair of tables is in use
+#define STRING_SPLIT__DONE  (1u << 5)
+
+static inline bool String__IsSpace(char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+SYM_WEAK
+StringView StringView_Of(const String* str)
+{
+    return (StringView){.len = str->len, .at = str->at};
+}
+
+SYM_WEAK
+StringView StringView_FromCStr(const char* cstr)
+{
+    return (StringView){.len = strlen(cstr), .at = cstr};
+}
+
+SYM_WEAK
+StringView StringView_Trim(StringView sv)
+{
+    while (sv.len && String__IsSpace(sv.at[0])) {
+        sv.at++;
+        sv.len--;
+    }
+
+    while (sv.len && String__IsSpace(sv.at[sv.len - 1])) sv.len--;
+
+    return sv;
+}
+
+// delimiter bitmask for bytes [0, len) of `ptr`, len <= 64
+static inline u64 StringSplit__ClassifyScalar(const StringSplit* self, const u8* ptr, usize len)
+{
+    u64 mask = 0;
+
+    if (self->mode & STRING_SPLIT__SET) {
+        for (usize ii = 0; ii < len; ii++) {
+            u8 table = ptr[ii] >> 7;
+            mask    |= (u64)((self->lo[table][ptr[ii] & 0x0F] & self->hi[table][ptr[ii] >> 4]) != 0) << ii;
+        }
+    } else {
+        for (usize ii = 0; ii < len; ii++) {
+            mask |= (u64)(ptr[ii] == self->delim) << ii;
+        }
+    }
+
+    return mask;
+}
+
+#if TARGET_ARCH == TARGET_ARCH_AMD64
+
+SYM_WEAK
+u64 StringSplit__ClassifyByteSse2(const u8* ptr, u8 delim)
+{
+    const __m128i splat = _mm_set1_epi8(delim);
+
+    u64 mask = 0;
+    for (usize ii = 0; ii < 64; ii += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(ptr + ii));
+        mask         |= (u64)(u16)_mm_movemask_epi8(_mm_cmpeq_epi8(block, splat)) << ii;
+    }
+
+    return mask;
+}
+
+SYM_WEAK ATTR(target("ssse3"))
+u64 StringSplit__ClassifySetSsse3(const StringSplit* self, const u8* ptr, usize tables)
+{
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+
+    u64 mask = 0;
+    for (usize tt = 0; tt < tables; tt++) {
+        const __m128i lo = _mm_load_si128((const __m128i*)self->lo[tt]);
+        const __m128i hi = _mm_load_si128((const __m128i*)self->hi[tt]);
+
+        for (usize ii = 0; ii < 64; ii += 16) {
+            __m128i block    = _mm_loadu_si128((const __m128i*)(ptr + ii));
+            __m128i lo_class = _mm_shuffle_epi8(lo, _mm_and_si128(block, nibble));
+            __m128i hi_class = _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi16(block, 4), nibble));
+            __m128i none     = _mm_cmpeq_epi8(_mm_and_si128(lo_class, hi_class), _mm_setzero_si128());
+
+            mask |= (u64)(u16)~_mm_movemask_epi8(none) << ii;
+        }
+    }
+
+    return mask;
+}
+
+SYM_WEAK ATTR(target("avx2"))
+u64 StringSplit__ClassifyByteAvx2(const u8* ptr, u8 delim)
+{
+    const __m256i splat = _mm256_set1_epi8(delim);
+
+    __m256i lo_block = _mm256_loadu_si256((const __m256i*)ptr);
+    __m256i hi_block = _mm256_loadu_si256((const __m256i*)(ptr + 32));
+
+    u64 lo_mask = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo_block, splat));
+    u64 hi_mask = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi_block, splat));
+
+    return lo_mask | (hi_mask << 32);
+}
+
+SYM_WEAK ATTR(target("avx2"))
+u64 StringSplit__ClassifySetAvx2(const StringSplit* self, const u8* ptr, usize tables)
+{
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+
+    u64 mask = 0;
+    for (usize tt = 0; tt < tables; tt++) {
+        const __m256i lo = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)self->lo[tt]));
+        const __m256i hi = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)self->hi[tt]));
+
+        for (usize ii = 0; ii < 64; ii += 32) {
+            __m256i block    = _mm256_loadu_si256((const __m256i*)(ptr + ii));
+            __m256i lo_class = _mm256_shuffle_epi8(lo, _mm256_and_si256(block, nibble));
+            __m256i hi_class = _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi16(block, 4), nibble));
+            __m256i none     = _mm256_cmpeq_epi8(_mm256_and_si256(lo_class, hi_class), _mm256_setzero_si256());
+
+            mask |= (u64)(u32)~_mm256_movemask_epi8(none) << ii;
+        }
+    }
+
+    return mask;
+}
+
+#endif
+
+// delimiter bitmask for the next (up to) 64 bytes
+static inline u64 StringSplit__Classify(const StringSplit* self, const u8* ptr, usize len)
+{
+#if TARGET_ARCH == TARGET_ARCH_AMD64
+    if (likely(len == 64)) {
+        i32 level = String__SimdLevel();
+
+        if (self->mode & STRING_SPLIT__SET) {
+            usize tables = (self->mode & STRING_SPLIT__HIGH) ? 2 : 1;
+            if (level >= STRING__SIMD_AVX2) return StringSplit__ClassifySetAvx2(self, ptr, tables);
+            if (level >= STRING__SIMD_SSSE3) return StringSplit__ClassifySetSsse3(self, ptr, tables);
+        } else {
+            if (level >= STRING__SIMD_AVX2) return StringSplit__ClassifyByteAvx2(ptr, self->delim);
+            return StringSplit__ClassifyByteSse2(ptr, self->delim);
+        }
+    }
+#endif
+
+    return StringSplit__ClassifyScalar(self, ptr, len);
+}
+
+static inline void StringSplit__Init(StringSplit* self, StringView sv, u32 mode)
+{
+    self->at    = sv.at;
+    self->len   = sv.len;
+    self->pos   = 0;
+    self->block = 0;
+    self->next  = 0;
+    self->mask  = 0;
+    self->mode  = mode;
+    self->delim = 0;
+}
+
+SYM_WEAK
+void StringSplit_New(StringSplit* self, StringView sv, char delim)
+{
+    StringSplit__Init(self, sv, STRING_SPLIT__BYTE);
+    self->delim = delim;
+}
+
+SYM_WEAK
+void StringSplit_New_Any(StringSplit* self, StringView sv, const char* delims)
+{
+    StringSplit__Init(self, sv, STRING_SPLIT__SET);
+
+    memset(self->lo, 0x00, sizeof(self->lo));
+    memset(self->hi, 0x00, sizeof(self->hi));
+
+    // a table covers 8 high nibbles with one bit each, so lo[l] holds exactly the high nibbles that pair with l
+    for (const u8* ptr = (const u8*)delims; *ptr; ptr++) {
+        u8 table = *ptr >> 7;
+        u8 bit   = 1 << ((*ptr >> 4) & 7);
+
+        self->hi[table][*ptr >> 4]   = bit;
+        self->lo[table][*ptr & 0x0F] |= bit;
+
+        if (table) self->mode |= STRING_SPLIT__HIGH;
+    }
+}
+
+SYM_WEAK
+void StringSplit_New_Lines(StringSplit* self, StringView sv)
+{
+    StringSplit__Init(self, sv, STRING_SPLIT__BYTE | STRING_SPLIT__LINES);
+    self->delim = '\n';
+}
+
+SYM_WEAK
+void StringSplit_New_Fields(StringSplit* self, StringView sv, char delim)
+{
+    StringSplit__Init(self, sv, STRING_SPLIT__BYTE | STRING_SPLIT__TRIM);
+    self->delim = delim;
+}
+
+SYM_WEAK
+bool StringSplit_Next(StringSplit* self, StringView* piece)
+{
+    if (self->mode & STRING_SPLIT__DONE) return false;
+
+    usize start = self->pos;
+    usize end;
+
+    for (;;) {
+        if (self->mask) {
+            end         = self->block + ctz_64(self->mask);
+            self->mask &= self->mask - 1;
+            self->pos   = end + 1;
+            break;
+        }
+
+        if (self->next >= self->len) {
+            end         = self->len;
+            self->mode |= STRING_SPLIT__DONE;
+
+            // "a\n" is a single line
+            if ((self->mode & STRING_SPLIT__LINES) && start == end) return false;
+            break;
+        }
+
+        usize len   = min(self->len - self->next, (usize)64);
+        self->block = self->next;
+        self->mask  = StringSplit__Classify(self, (const u8*)self->at + self->next, len);
+        self->next += len;
+    }
+
+    *piece = (StringView){.len = end - start, .at = self->at + start};
+
+    if ((self->mode & STRING_SPLIT__LINES) && piece->len && piece->at[piece->len - 1] == '\r') piece->len--;
+    if (self->mode & STRING_SPLIT__TRIM) *piece = StringView_Trim(*piece);
+
+    return true;
+}
+
+/* --- String Builder --- */
+
+SYM_WEAK
+void StringBuilder_New(StringBuilder* self, MemoryArena* arena)
+{
+    self->arena = arena;
+    self->head  = NULL;
+    self->tail  = NULL;
+    self->len   = 0;
+}
+
+SYM_WEAK
+void StringBuilder_Clear(StringBuilder* self)
+{
+    self->head = NULL;
+    self->tail = NULL;
+    self->len  = 0;
+}
+
+// empty chunk whose pieces will start at `at` (0 for appending, STRING_BUILDER_CHUNK_PIECES for prepending)
+SYM_WEAK
+StringBuilderChunk* StringBuilder__NewChunk(StringBuilder* self, u32 at)
+{
+    StringBuilderChunk* chunk = MemoryArena_UAlloc(self->arena, sizeof(StringBuilderChunk));
+    if (!chunk) return NULL;
+
+    chunk->prev  = NULL;
+    chunk->next  = NULL;
+    chunk->begin = at;
+    chunk->end   = at;
+
+    return chunk;
+}
+
+SYM_WEAK
+bool StringBuilder_Append(StringBuilder* self, StringView sv)
+{
+    if (!sv.len) return true;
+
+    StringBuilderChunk* tail = self->tail;
+    if (tail && tail->begin != tail->end) {
+        StringView* last = &tail->pieces[tail->end - 1];
+        if (last->at + last->len == sv.at) {
+            last->len += sv.len;
+            self->len += sv.len;
+            return true;
+        }
+    }
+
+    if (!tail || tail->end == STRING_BUILDER_CHUNK_PIECES) {
+        StringBuilderChunk* chunk = StringBuilder__NewChunk(self, 0);
+        if (!chunk) return false;
+
+        chunk->prev = tail;
+        if (tail) {
+            tail->next = chunk;
+        } else {
+            self->head = chunk;
+        }
+
+        self->tail = tail = chunk;
+    }
+
+    tail->pieces[tail->end++] = sv;
+    self->len += sv.len;
+
+    return true;
+}
+
+SYM_WEAK
+bool StringBuilder_Prepend(StringBuilder* self, StringView sv)
+{
+    if (!sv.len) return true;
+
+    StringBuilderChunk* head = self->head;
+    if (head && head->begin != head->end) {
+        StringView* first = &head->pieces[head->begin];
+        if (sv.at + sv.len == first->at) {
+            first->at   = sv.at;
+            first->len += sv.len;
+            self->len  += sv.len;
+            return true;
+        }
+    }
+
+    if (!head || head->begin == 0) {
+        StringBuilderChunk* chunk = StringBuilder__NewChunk(self, STRING_BUILDER_CHUNK_PIECES);
+        if (!chunk) return false;
+
+        chunk->next = head;
+        if (head) {
+            head->prev = chunk;
+        } else {
+            self->tail = chunk;
+        }
+
+        self->head = head = chunk;
+    }
+
+    head->pieces[--head->begin] = sv;
+    self->len += sv.len;
+
+    return true;
+}
+
+SYM_WEAK
+bool StringBuilder_AppendString(StringBuilder* self, const String* str)
+{
+    return StringBuilder_Append(self, (StringView){.len = str->len, .at = str->at});
+}
+
+SYM_WEAK
+bool StringBuilder_PrependString(StringBuilder* self, const String* str)
+{
+    return StringBuilder_Prepend(self, (StringView){.len = str->len, .at = str->at});
+}
+
+SYM_WEAK
+bool StringBuilder_AppendCopy(StringBuilder* self, const void* data, usize len)
+{
+    if (!len) return true;
+
+    // packed, so consecutive copies land back to back and merge into one piece
+    char* copy = MemoryArena_UPackedAlloc(self->arena, len);
+    if (!copy) return false;
+
+    memcpy(copy, data, len);
+    return StringBuilder_Append(self, (StringView){.len = len, .at = copy});
+}
+
+SYM_WEAK
+bool StringBuilder_PrependCopy(StringBuilder* self, const void* data, usize len)
+{
+    if (!len) return true;
+
+    char* copy = MemoryArena_UPackedAlloc(self->arena, len);
+    if (!copy) return false;
+
+    memcpy(copy, data, len);
+    return StringBuilder_Prepend(self, (StringView){.len = len, .at = copy});
+}
+
+SYM_WEAK
+usize StringBuilder_Length(const StringBuilder* self)
+{
+    return self->len;
+}
+
+SYM_WEAK
+void StringBuilder_CopyTo(const StringBuilder* self, char* dst)
+{
+    for (const StringBuilderChunk* chunk = self->head; chunk; chunk = chunk->next) {
+        for (u32 ii = chunk->begin; ii < chunk->end; ii++) {
+            memcpy(dst, chunk->pieces[ii].at, chunk->pieces[ii].len);
+            dst += chunk->pieces[ii].len;
+        }
+    }
+}
+
+SYM_WEAK
+String* StringBuilder_Build(const StringBuilder* self, MemoryArena* arena)
+{
+    String* str = MemoryArena_UAlignedAlloc(arena, _Alignof(String), sizeof(String) + self->len + 1);
+    if (!str) return NULL;
+
+    char* at = (char*)str->at;
+    StringBuilder_CopyTo(self, at);
+    at[self->len] = '\0';
+
+    str->len = self->len;
+    return str;
+}
+
+// drops the first `len` bytes
+SYM_WEAK
+void StringBuilder__Consume(StringBuilder* self, usize len)
+{
+    self->len -= len;
+
+    while (len) {
+        StringBuilderChunk* head  = self->head;
+        StringView*         piece = &head->pieces[head->begin];
+
+        if (piece->len > len) {
+            piece->at  += len;
+            piece->len -= len;
+            break;
+        }
+
+        len -= piece->len;
+        if (++head->begin == head->end) {
+            self->head = head->next;
+            if (self->head) {
+                self->head->prev = NULL;
+            } else {
+                self->tail = NULL;
+            }
+        }
+    }
+}
+
+SYM_WEAK
+isize StringBuilder_WriteToFd(StringBuilder* self, int fd)
+{
+    usize total = 0;
+
+    while (self->len) {
+        // StringView has its fields the other way around from iovec, so a chunk's worth of pieces is converted per call
+        struct iovec iov[STRING_BUILDER_CHUNK_PIECES];
+        int          niov = 0;
+        usize        want = 0;
+
+        for (const StringBuilderChunk* chunk = self->head; chunk && niov < STRING_BUILDER_CHUNK_PIECES; chunk = chunk->next) {
+            for (u32 ii = chunk->begin; ii < chunk->end && niov < STRING_BUILDER_CHUNK_PIECES; ii++) {
+                iov[niov++] = (struct iovec){.iov_base = (void*)chunk->pieces[ii].at, .iov_len = chunk->pieces[ii].len};
+                want       += chunk->pieces[ii].len;
+            }
+        }
+
+        ssize_t put = writev(fd, iov, niov);
+        if (put < 0) {
+            if (errno == EINTR) continue;
+            if (total) break;
+            return -1;
+        }
+
+        StringBuilder__Consume(self, put);
+        total += put;
+
+        // a short write means the fd's buffer is full
+        if ((usize)put < want) break;
+    }
+
+    return total;
+}
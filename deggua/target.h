@@ -137,6 +137,17 @@
 # endif
 #endif
 
+/* --- TARGET_CACHE_LINE_SIZE --- */
+// destructive interference size, used to keep independently written data on separate lines
+
+#if TARGET_ARCH == TARGET_ARCH_AMD64 || TARGET_ARCH == TARGET_ARCH_I386 || TARGET_ARCH == TARGET_ARCH_ARM64
+# define TARGET_CACHE_LINE_SIZE (64)
+#elif TARGET_ARCH == TARGET_ARCH_POWERPC || TARGET_ARCH == TARGET_ARCH_POWERPC64
+# define TARGET_CACHE_LINE_SIZE (128)
+#else
+# define TARGET_CACHE_LINE_SIZE (64)
+#endif
+
 /* --- TARGET_ABI --- */
 // TODO: this is trickier, there aren't explicit defines as far as I can tell
 // so you have to determine it based on the compiler and target OS + arch
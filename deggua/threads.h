@@ -1,8 +1,1132 @@
-// Threads
-// Thread Local Storage
-// Mutexes
-// Semaphores
-// Atomics
-// MRSW locks
-// Thread pools
-// etc.
+#pragma once
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#if __has_include(<sys/rseq.h>)
+# include <sys/rseq.h>
+#endif
+
+#include <deggua/types.h>
+#include <deggua/bitops.h>
+
+// Threading primitives for Linux on top of pthreads, futexes and the glibc rseq area: dynamic thread local slots,
+// per-CPU sharded counters, 4 byte locks (Mutex, Semaphore, CondVar, Event, Latch), read mostly locks (RwLock,
+// SeqLock) and a work stealing ThreadPool.
+
+/* --- Futex --- */
+// Thin wrappers over the futex syscall (process private), the building block for the blocking primitives below
+
+int  Futex_Wait(u32* addr, u32 expected, const struct timespec* timeout); // Sleep while *addr == expected, returns 0 or -1 w/ errno (EAGAIN, ETIMEDOUT, EINTR)
+void Futex_Wake(u32* addr, u32 count);                                   // Wake up to `count` waiters on `addr`
+int  Futex_Requeue(u32* addr, u32 expected, u32 count, u32* target);     // Wake up to `count` waiters and move the rest to `target` if *addr == expected, -1 w/ errno (EAGAIN) otherwise
+
+/* --- Thread Local Storage --- */
+// Dynamically allocated thread local slots, for per-object thread local state where `_Thread_local` doesn't fit.
+// Values live in a fixed per-thread array so a lookup is a TLS load and an index, destructors run on thread exit for
+// the slots the thread set.
+
+#define THREAD_LOCAL_SLOTS (64)
+
+typedef struct {
+    u32 index;
+    u32 generation; // tells values of a deleted key apart from a key reusing the slot
+} ThreadLocal;
+
+bool               ThreadLocal_New(ThreadLocal* self, void (*destructor)(void* value)); // false once every slot is taken, `destructor` may be NULL
+void               ThreadLocal_Delete(ThreadLocal* self);                               // Values still set in other threads are dropped without their destructor
+static inline void* ThreadLocal_Get(const ThreadLocal* self);                           // NULL until the thread sets it
+bool               ThreadLocal_Set(const ThreadLocal* self, void* value);               // false if the exit hook couldn't be installed
+
+static inline usize Thread_Index(void); // small per-thread index, handed out in order of first use (0, 1, ...)
+static inline usize Thread_Shard(void); // CPU the thread is running on (from rseq), the thread index where unavailable
+
+/* --- Sharded Counters --- */
+// Counter split into one cache line per CPU, increments go to the running CPU's cell so concurrent writers on
+// different cores don't share a line, reads add up every cell. For hot statistics that are read rarely.
+
+typedef struct {
+    u64 value;
+} ATTR(aligned(TARGET_CACHE_LINE_SIZE)) ShardedCounter__Cell;
+
+typedef struct {
+    ShardedCounter__Cell* cells;
+    usize                 mask; // cells - 1
+} ShardedCounter;
+
+bool               ShardedCounter_New(ShardedCounter* self); // one cell per configured CPU
+void               ShardedCounter_Delete(ShardedCounter* self);
+static inline void ShardedCounter_Add(ShardedCounter* self, u64 value);
+u64                ShardedCounter_Read(const ShardedCounter* self);  // Sum of the cells, concurrent adds may or may not be included
+u64                ShardedCounter_Reset(ShardedCounter* self);       // Zero the counter, returns the sum that was taken out
+
+/* --- Locks --- */
+// Futex backed, 4 bytes each and zero initialized. Uncontended operations are a single atomic RMW, the kernel is only
+// entered once a thread actually has to sleep and wakeups are handed to one thread at a time where the semantics allow.
+
+#define MUTEX_SPIN    (100)    // rounds spent waiting for a running owner before going to sleep
+#define SEMAPHORE_MAX (U32_C(0xFFFF)) // highest count a Semaphore can hold
+
+typedef struct {
+    u32 state; // 0 unlocked, 1 locked, 2 locked with (possible) sleepers
+} Mutex;
+
+typedef struct {
+    u32 state; // count in the low 16 bits, sleeping waiters in the high 16
+} Semaphore;
+
+typedef struct {
+    u32 seq; // bumped by every signal, bit 0 set while threads may be waiting
+} CondVar;
+
+typedef struct {
+    u32 state; // 0 reset, 1 set, 2 reset with sleepers
+} Event;
+
+typedef struct {
+    u32 state; // remaining count, top bit set while threads sleep in Latch_Wait
+} Latch;
+
+#define MUTEX_INIT   {0}
+#define CONDVAR_INIT {0}
+#define EVENT_INIT   {0}
+
+// the fast paths are inline, the rest only runs once a thread has to wait
+static inline void Mutex_Lock(Mutex* self);
+static inline bool Mutex_TryLock(Mutex* self);
+static inline void Mutex_Unlock(Mutex* self);
+
+void               Semaphore_New(Semaphore* self, u32 count); // `count` is clamped to SEMAPHORE_MAX
+void               Semaphore_Wait(Semaphore* self);
+static inline bool Semaphore_TryWait(Semaphore* self);
+static inline void Semaphore_Post(Semaphore* self); // wakes at most one waiter, posts past SEMAPHORE_MAX are dropped
+
+void               CondVar_Wait(CondVar* self, Mutex* mutex);                          // `mutex` is held on entry and on return, wakeups may be spurious
+bool               CondVar_WaitTimeout(CondVar* self, Mutex* mutex, usize timeout_ms); // false on timeout
+static inline void CondVar_Signal(CondVar* self);
+void               CondVar_Broadcast(CondVar* self, Mutex* mutex); // `mutex` must be the one the waiters use, they're moved onto it instead of all waking at once
+
+void               Event_Set(Event* self); // wakes every waiter, stays set until reset
+void               Event_Reset(Event* self);
+void               Event_Wait(Event* self);
+static inline bool Event_IsSet(Event* self);
+
+void               Latch_New(Latch* self, u32 count); // up to 2^31 - 1
+void               Latch_CountDown(Latch* self);      // the last count down wakes every waiter
+void               Latch_Wait(Latch* self);
+static inline bool Latch_TryWait(Latch* self);
+
+/* --- Read Mostly Locks --- */
+// RwLock keeps a reader count per CPU (one cache line each, picked by Thread_Shard) so readers on different cores
+// don't write the same line, writers pay for it by scanning every slot. A reader may migrate while it holds the lock,
+// so ReadLock returns the slot it counted on and ReadUnlock takes it back. Writers take precedence: new readers back
+// off while a writer holds or waits for the lock.
+// SeqLock readers don't write at all, they copy the data and retry if a writer ran meanwhile. For small POD snapshots.
+
+typedef struct {
+    u32 readers;
+} ATTR(aligned(TARGET_CACHE_LINE_SIZE)) RwLock__Slot;
+
+typedef struct {
+    u32           writer;   // 0 free, 1 held, 2 held with sleepers (readers or writers)
+    u32           mask;     // slots - 1
+    RwLock__Slot* slots;
+} RwLock;
+
+typedef struct {
+    u32 seq; // odd while a write is in progress
+} SeqLock;
+
+#define SEQLOCK_INIT {0}
+
+bool               RwLock_New(RwLock* self); // one slot per configured CPU
+void               RwLock_Delete(RwLock* self);
+static inline u32  RwLock_ReadLock(RwLock* self); // returns the slot to pass to ReadUnlock
+static inline void RwLock_ReadUnlock(RwLock* self, u32 slot_index);
+void               RwLock_WriteLock(RwLock* self);
+void               RwLock_WriteUnlock(RwLock* self);
+
+// read side, loop until ReadRetry returns false: `do { seq = SeqLock_ReadBegin(lock); ...copy... } while (SeqLock_ReadRetry(lock, seq));`
+// the data may be torn while a writer is active, only act on it once ReadRetry passed
+static inline u32  SeqLock_ReadBegin(const SeqLock* self);
+static inline bool SeqLock_ReadRetry(const SeqLock* self, u32 seq);
+static inline void SeqLock_WriteBegin(SeqLock* self); // writers exclude each other
+static inline void SeqLock_WriteEnd(SeqLock* self);
+
+void SeqLock_Read(const SeqLock* self, void* restrict dst, const void* src, usize size); // consistent copy of `size` bytes at `src`
+void SeqLock_Write(SeqLock* self, void* dst, const void* restrict src, usize size);     // copies `size` bytes to `dst` as one write
+
+/* --- Thread Pool --- */
+// Worker threads with a work stealing deque each. Tasks spawned from a worker go to its own deque (it runs the newest
+// first, thieves take the oldest), tasks spawned from other threads go through a shared queue. Waiting on a task
+// group runs queued tasks until there are none left, so the waiting thread works alongside the pool.
+
+#define THREAD_POOL_QUEUE_SIZE  (4096) // tasks per worker deque, spawning into a full one runs the task inline
+#define THREAD_POOL_INJECT_SIZE (4096) // tasks in the shared queue, same
+#define THREAD_POOL_SPIN        (128)  // rounds an idle thread keeps looking for tasks before it sleeps
+
+typedef struct {
+    u32 state; // unfinished tasks, top bit set while a thread sleeps in ThreadPool_Wait
+} TaskGroup;
+
+#define TASK_GROUP_INIT {0}
+
+typedef struct {
+    void       (*fn)(void* arg); // NULL for a ParallelFor range, `arg` is the loop
+    void*      arg;
+    usize      begin;
+    usize      end;
+    TaskGroup* group;
+} ThreadPoolTask;
+
+#define T ThreadPoolTask
+#include <deggua/generic/steal_deque.h>
+
+#define T ThreadPoolTask
+#include <deggua/generic/mpmc_queue.h>
+
+typedef struct {
+    struct ThreadPoolWorker*  workers;
+    usize                     num_workers;
+    MpmcQueue(ThreadPoolTask) inject; // tasks spawned from outside the pool
+
+    u32 signal   ATTR(aligned(TARGET_CACHE_LINE_SIZE)); // bumped to wake sleeping workers
+    u32 sleeping;                                       // workers asleep on `signal`
+    u32 stopping;
+} ThreadPool;
+
+bool ThreadPool_New(ThreadPool* self, usize num_threads); // 0 => one worker per online CPU besides the calling thread
+void ThreadPool_Delete(ThreadPool* self);                 // Waits for running tasks, queued ones are dropped
+
+void ThreadPool_Spawn(ThreadPool* self, TaskGroup* group, void (*fn)(void* arg), void* arg); // Queue `fn(arg)` as part of `group`
+void ThreadPool_Wait(ThreadPool* self, TaskGroup* group);                                   // Run tasks until every task in `group` finished
+
+// Calls `fn(ctx, lo, hi)` over disjoint subranges covering [begin, end) and waits for them, ranges are split in halves
+// while other workers are out of tasks but never below `grain` elements (0 => picked from the range and pool size)
+void ThreadPool_ParallelFor(ThreadPool* self, usize begin, usize end, usize grain, void (*fn)(void* ctx, usize lo, usize hi), void* ctx);
+
+/* --- Implementation --- */
+
+SYM_WEAK
+int Futex_Wait(u32* addr, u32 expected, const struct timespec* timeout)
+{
+    return syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, expected, timeout, NULL, 0);
+}
+
+SYM_WEAK
+void Futex_Wake(u32* addr, u32 count)
+{
+    syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, min(count, (u32)INT32_MAX), NULL, NULL, 0);
+}
+
+SYM_WEAK
+int Futex_Requeue(u32* addr, u32 expected, u32 count, u32* target)
+{
+    return syscall(SYS_futex, addr, FUTEX_CMP_REQUEUE_PRIVATE, min(count, (u32)INT32_MAX), (uptr)INT32_MAX, target, expected);
+}
+
+/* --- Thread Local Storage --- */
+
+typedef struct {
+    void* value;
+    u32   generation;
+} ThreadLocal__Value;
+
+SYM_WEAK struct {
+    u64            used; // slot bitmap
+    u32            generation[THREAD_LOCAL_SLOTS];
+    void           (*destructor[THREAD_LOCAL_SLOTS])(void* value);
+    u32            lock;
+    pthread_once_t once;
+    pthread_key_t  exit_key;
+    bool           exit_hook;
+} ThreadLocal__registry = {.once = PTHREAD_ONCE_INIT};
+
+SYM_WEAK _Thread_local ThreadLocal__Value ThreadLocal__values[THREAD_LOCAL_SLOTS];
+SYM_WEAK _Thread_local bool               ThreadLocal__hooked;
+
+SYM_WEAK u32                Thread__next_index;
+SYM_WEAK _Thread_local u32  Thread__index;
+SYM_WEAK _Thread_local bool Thread__has_index;
+
+static inline void ThreadLocal__Lock(void)
+{
+    while (__atomic_exchange_n(&ThreadLocal__registry.lock, 1, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(&ThreadLocal__registry.lock, __ATOMIC_RELAXED)) {
+            CPU_RELAX();
+        }
+    }
+}
+
+static inline void ThreadLocal__Unlock(void)
+{
+    __atomic_store_n(&ThreadLocal__registry.lock, 0, __ATOMIC_RELEASE);
+}
+
+// runs the destructors of the slots the exiting thread set
+SYM_WEAK
+void ThreadLocal__Exit(void* arg)
+{
+    UNUSED(arg);
+
+    for (usize ii = 0; ii < THREAD_LOCAL_SLOTS; ii++) {
+        ThreadLocal__Value* value = &ThreadLocal__values[ii];
+        if (!value->value) continue;
+
+        ThreadLocal__Lock();
+        bool live = value->generation == ThreadLocal__registry.generation[ii];
+        void (*destructor)(void* value) = ThreadLocal__registry.destructor[ii];
+        ThreadLocal__Unlock();
+
+        if (live && destructor) destructor(value->value);
+        value->value = NULL;
+    }
+}
+
+SYM_WEAK
+void ThreadLocal__Init(void)
+{
+    ThreadLocal__registry.exit_hook = !pthread_key_create(&ThreadLocal__registry.exit_key, ThreadLocal__Exit);
+}
+
+SYM_WEAK
+bool ThreadLocal_New(ThreadLocal* self, void (*destructor)(void* value))
+{
+    pthread_once(&ThreadLocal__registry.once, ThreadLocal__Init);
+
+    ThreadLocal__Lock();
+
+    u64 free = ~ThreadLocal__registry.used;
+    if (!free) {
+        ThreadLocal__Unlock();
+        return false;
+    }
+
+    usize index = ctz_64(free);
+    ThreadLocal__registry.used |= U64_C(1) << index;
+
+    // 0 is the generation of a value that was never set
+    u32 generation = ThreadLocal__registry.generation[index] + 1;
+    if (!generation) generation = 1;
+
+    ThreadLocal__registry.generation[index] = generation;
+    ThreadLocal__registry.destructor[index] = destructor;
+
+    ThreadLocal__Unlock();
+
+    self->index      = index;
+    self->generation = generation;
+
+    return true;
+}
+
+SYM_WEAK
+void ThreadLocal_Delete(ThreadLocal* self)
+{
+    ThreadLocal__Lock();
+
+    // values left behind no longer match any generation handed out until the counter wraps
+    ThreadLocal__registry.generation[self->index]++;
+    ThreadLocal__registry.used &= ~(U64_C(1) << self->index);
+
+    ThreadLocal__Unlock();
+}
+
+static inline void* ThreadLocal_Get(const ThreadLocal* self)
+{
+    ThreadLocal__Value* value = &ThreadLocal__values[self->index];
+    return value->generation == self->generation ? value->value : NULL;
+}
+
+SYM_WEAK
+bool ThreadLocal_Set(const ThreadLocal* self, void* value)
+{
+    if (unlikely(!ThreadLocal__hooked) && value) {
+        // any non-NULL value makes pthread call the exit hook for this thread
+        if (!ThreadLocal__registry.exit_hook || pthread_setspecific(ThreadLocal__registry.exit_key, &ThreadLocal__hooked)) return false;
+        ThreadLocal__hooked = true;
+    }
+
+    ThreadLocal__values[self->index].value      = value;
+    ThreadLocal__values[self->index].generation = self->generation;
+
+    return true;
+}
+
+static inline usize Thread_Index(void)
+{
+    if (unlikely(!Thread__has_index)) {
+        Thread__index     = __atomic_fetch_add(&Thread__next_index, 1, __ATOMIC_RELAXED);
+        Thread__has_index = true;
+    }
+
+    return Thread__index;
+}
+
+static inline usize Thread_Shard(void)
+{
+#if __has_include(<sys/rseq.h>)
+    // glibc registers rseq for every thread, the kernel keeps `cpu_id` current across migrations
+    if (likely(__rseq_size)) {
+        const struct rseq* rseq = (const struct rseq*)((u8*)__builtin_thread_pointer() + __rseq_offset);
+
+        i32 cpu = (i32)__atomic_load_n(&rseq->cpu_id, __ATOMIC_RELAXED);
+        if (likely(cpu >= 0)) return cpu;
+    }
+#endif
+
+    return Thread_Index();
+}
+
+/* --- Sharded Counters --- */
+
+SYM_WEAK
+bool ShardedCounter_New(ShardedCounter* self)
+{
+    usize count = 1;
+    while (count < (usize)max(sysconf(_SC_NPROCESSORS_CONF), 1)) count *= 2;
+
+    self->cells = ALIGNED_MALLOC(TARGET_CACHE_LINE_SIZE, count * sizeof(ShardedCounter__Cell));
+    if (!self->cells) return false;
+
+    memset(self->cells, 0x00, count * sizeof(ShardedCounter__Cell));
+    self->mask = count - 1;
+
+    return true;
+}
+
+SYM_WEAK
+void ShardedCounter_Delete(ShardedCounter* self)
+{
+    ALIGNED_FREE(self->cells);
+    self->cells = NULL;
+}
+
+static inline void ShardedCounter_Add(ShardedCounter* self, u64 value)
+{
+    // still atomic, the thread can migrate between picking the cell and adding, but the line stays local to the core
+    __atomic_fetch_add(&self->cells[Thread_Shard() & self->mask].value, value, __ATOMIC_RELAXED);
+}
+
+SYM_WEAK
+u64 ShardedCounter_Read(const ShardedCounter* self)
+{
+    u64 sum = 0;
+    for (usize ii = 0; ii <= self->mask; ii++) {
+        sum += __atomic_load_n(&self->cells[ii].value, __ATOMIC_RELAXED);
+    }
+
+    return sum;
+}
+
+SYM_WEAK
+u64 ShardedCounter_Reset(ShardedCounter* self)
+{
+    u64 sum = 0;
+    for (usize ii = 0; ii <= self->mask; ii++) {
+        sum += __atomic_exchange_n(&self->cells[ii].value, 0, __ATOMIC_RELAXED);
+    }
+
+    return sum;
+}
+
+/* --- Locks --- */
+
+#define SEMAPHORE__COUNT  (U32_C(0xFFFF))
+#define SEMAPHORE__WAITER (U32_C(1) << 16)
+#define CONDVAR__WAITERS  (U32_C(1))
+#define LATCH__SLEEPING   (U32_C(1) << 31)
+
+SYM_WEAK ATTR(noinline)
+void Mutex__LockContended(Mutex* self)
+{
+    // the owner is likely to let go soon if nobody is queued yet, wait for it without sleeping
+    for (usize ii = 0; ii < MUTEX_SPIN; ii++) {
+        u32 state = __atomic_load_n(&self->state, __ATOMIC_RELAXED);
+        if (state == 0 && __atomic_compare_exchange_n(&self->state, &state, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            return;
+        }
+
+        if (state == 2) break;
+        CPU_RELAX();
+    }
+
+    // we can't tell if other sleepers remain once we get it, so it's always taken as contended from here
+    while (__atomic_exchange_n(&self->state, 2, __ATOMIC_ACQUIRE)) {
+        Futex_Wait(&self->state, 2, NULL);
+    }
+}
+
+static inline void Mutex_Lock(Mutex* self)
+{
+    u32 unlocked = 0;
+    if (likely(__atomic_compare_exchange_n(&self->state, &unlocked, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))) return;
+
+    Mutex__LockContended(self);
+}
+
+static inline bool Mutex_TryLock(Mutex* self)
+{
+    u32 unlocked = 0;
+    return __atomic_compare_exchange_n(&self->state, &unlocked, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+static inline void Mutex_Unlock(Mutex* self)
+{
+    if (unlikely(__atomic_exchange_n(&self->state, 0, __ATOMIC_RELEASE) == 2)) Futex_Wake(&self->state, 1);
+}
+
+SYM_WEAK
+void Semaphore_New(Semaphore* self, u32 count)
+{
+    self->state = min(count, SEMAPHORE_MAX);
+}
+
+static inline bool Semaphore_TryWait(Semaphore* self)
+{
+    u32 state = __atomic_load_n(&self->state, __ATOMIC_RELAXED);
+    while (state & SEMAPHORE__COUNT) {
+        if (__atomic_compare_exchange_n(&self->state, &state, state - 1, true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) return true;
+    }
+
+    return false;
+}
+
+SYM_WEAK
+void Semaphore_Wait(Semaphore* self)
+{
+    for (usize ii = 0; ii < MUTEX_SPIN; ii++) {
+        if (Semaphore_TryWait(self)) return;
+        CPU_RELAX();
+    }
+
+    // registered as a waiter for the whole wait, posts only enter the kernel while someone is registered
+    u32 state = __atomic_add_fetch(&self->state, SEMAPHORE__WAITER, __ATOMIC_RELAXED);
+    for (;;) {
+        if (state & SEMAPHORE__COUNT) {
+            u32 taken = state - 1 - SEMAPHORE__WAITER;
+            if (__atomic_compare_exchange_n(&self->state, &state, taken, true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) return;
+            continue;
+        }
+
+        Futex_Wait(&self->state, state, NULL);
+        state = __atomic_load_n(&self->state, __ATOMIC_RELAXED);
+    }
+}
+
+static inline void Semaphore_Post(Semaphore* self)
+{
+    // saturates, a carry out of the count would land in the waiter count
+    u32 state = __atomic_load_n(&self->state, __ATOMIC_RELAXED);
+    do {
+        if ((state & SEMAPHORE__COUNT) == SEMAPHORE_MAX) return;
+    } while (!__atomic_compare_exchange_n(&self->state, &state, state + 1, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+    if (state >= SEMAPHORE__WAITER) Futex_Wake(&self->state, 1);
+}
+
+SYM_WEAK
+void CondVar_Wait(CondVar* self, Mutex* mutex)
+{
+    // read (and flag) the sequence before letting go of the mutex, a signal after that changes it
+    u32 seq = __atomic_or_fetch(&self->seq, CONDVAR__WAITERS, __ATOMIC_RELAXED);
+
+    Mutex_Unlock(mutex);
+    Futex_Wait(&self->seq, seq, NULL);
+
+    // other waiters may have been requeued behind us, keep the mutex marked as contended
+    while (__atomic_exchange_n(&mutex->state, 2, __ATOMIC_ACQUIRE)) {
+        Futex_Wait(&mutex->state, 2, NULL);
+    }
+}
+
+SYM_WEAK
+bool CondVar_WaitTimeout(CondVar* self, Mutex* mutex, usize timeout_ms)
+{
+    u32 seq = __atomic_or_fetch(&self->seq, CONDVAR__WAITERS, __ATOMIC_RELAXED);
+
+    struct timespec timeout = {.tv_sec = timeout_ms / 1000, .tv_nsec = timeout_ms % 1000 * 1000000};
+
+    Mutex_Unlock(mutex);
+    bool timed_out = Futex_Wait(&self->seq, seq, &timeout) && errno == ETIMEDOUT;
+
+    while (__atomic_exchange_n(&mutex->state, 2, __ATOMIC_ACQUIRE)) {
+        Futex_Wait(&mutex->state, 2, NULL);
+    }
+
+    return !timed_out;
+}
+
+static inline void CondVar_Signal(CondVar* self)
+{
+    if (!(__atomic_load_n(&self->seq, __ATOMIC_RELAXED) & CONDVAR__WAITERS)) return;
+
+    __atomic_add_fetch(&self->seq, 2, __ATOMIC_RELEASE);
+    Futex_Wake(&self->seq, 1);
+}
+
+SYM_WEAK
+void CondVar_Broadcast(CondVar* self, Mutex* mutex)
+{
+    // every current waiter is woken or requeued so nobody is left to flag, the next waiter sets it again
+    u32 seq = __atomic_load_n(&self->seq, __ATOMIC_RELAXED);
+    u32 next;
+    do {
+        if (!(seq & CONDVAR__WAITERS)) return;
+        next = (seq + 2) & ~CONDVAR__WAITERS;
+    } while (!__atomic_compare_exchange_n(&self->seq, &seq, next, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+    // one waiter takes the mutex, the rest sleep on the mutex itself and are woken one at a time by its unlocks.
+    // A new waiter changed the sequence in between if the requeue is refused, wake everyone instead.
+    if (Futex_Requeue(&self->seq, next, 1, &mutex->state) < 0) Futex_Wake(&self->seq, INT32_MAX);
+}
+
+SYM_WEAK
+void Event_Set(Event* self)
+{
+    if (__atomic_exchange_n(&self->state, 1, __ATOMIC_RELEASE) == 2) Futex_Wake(&self->state, INT32_MAX);
+}
+
+SYM_WEAK
+void Event_Reset(Event* self)
+{
+    u32 set = 1;
+    __atomic_compare_exchange_n(&self->state, &set, 0, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+SYM_WEAK
+void Event_Wait(Event* self)
+{
+    u32 state = __atomic_load_n(&self->state, __ATOMIC_ACQUIRE);
+    while (state != 1) {
+        if (state == 2 || __atomic_compare_exchange_n(&self->state, &state, 2, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+            Futex_Wait(&self->state, 2, NULL);
+            state = __atomic_load_n(&self->state, __ATOMIC_ACQUIRE);
+        }
+    }
+}
+
+static inline bool Event_IsSet(Event* self)
+{
+    return __atomic_load_n(&self->state, __ATOMIC_ACQUIRE) == 1;
+}
+
+SYM_WEAK
+void Latch_New(Latch* self, u32 count)
+{
+    self->state = count & ~LATCH__SLEEPING;
+}
+
+SYM_WEAK
+void Latch_CountDown(Latch* self)
+{
+    u32 state = __atomic_sub_fetch(&self->state, 1, __ATOMIC_ACQ_REL);
+    if (state == LATCH__SLEEPING) Futex_Wake(&self->state, INT32_MAX);
+}
+
+static inline bool Latch_TryWait(Latch* self)
+{
+    return !(__atomic_load_n(&self->state, __ATOMIC_ACQUIRE) & ~LATCH__SLEEPING);
+}
+
+SYM_WEAK
+void Latch_Wait(Latch* self)
+{
+    u32 state = __atomic_load_n(&self->state, __ATOMIC_ACQUIRE);
+    while (state & ~LATCH__SLEEPING) {
+        if ((state & LATCH__SLEEPING)
+            || __atomic_compare_exchange_n(&self->state, &state, state | LATCH__SLEEPING, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+            Futex_Wait(&self->state, state | LATCH__SLEEPING, NULL);
+            state = __atomic_load_n(&self->state, __ATOMIC_ACQUIRE);
+        }
+    }
+}
+
+/* --- Read Mostly Locks --- */
+
+// the CPU we're on, or the thread index where rseq isn't available
+static inline u32 RwLock__ThreadSlot(RwLock* self)
+{
+    return Thread_Shard() & self->mask;
+}
+
+SYM_WEAK
+bool RwLock_New(RwLock* self)
+{
+    usize count = 1;
+    while (count < (usize)max(sysconf(_SC_NPROCESSORS_CONF), 1)) count *= 2;
+
+    self->slots = ALIGNED_MALLOC(TARGET_CACHE_LINE_SIZE, count * sizeof(RwLock__Slot));
+    if (!self->slots) return false;
+
+    memset(self->slots, 0x00, count * sizeof(RwLock__Slot));
+    self->writer = 0;
+    self->mask   = count - 1;
+
+    return true;
+}
+
+SYM_WEAK
+void RwLock_Delete(RwLock* self)
+{
+    ALIGNED_FREE(self->slots);
+    self->slots = NULL;
+}
+
+SYM_WEAK ATTR(noinline)
+void RwLock__WaitWriter(RwLock* self)
+{
+    u32 writer = __atomic_load_n(&self->writer, __ATOMIC_RELAXED);
+    for (usize ii = 0; writer && ii < MUTEX_SPIN; ii++) {
+        CPU_RELAX();
+        writer = __atomic_load_n(&self->writer, __ATOMIC_RELAXED);
+    }
+
+    while (writer) {
+        if (writer == 2 || __atomic_compare_exchange_n(&self->writer, &writer, 2, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            Futex_Wait(&self->writer, 2, NULL);
+            writer = __atomic_load_n(&self->writer, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static inline u32 RwLock_ReadLock(RwLock* self)
+{
+    u32           index = RwLock__ThreadSlot(self);
+    RwLock__Slot* slot  = &self->slots[index];
+
+    for (;;) {
+        // announce the read, then check for writers, a writer does the opposite so one of us sees the other
+        __atomic_add_fetch(&slot->readers, 1, __ATOMIC_SEQ_CST);
+        if (likely(!__atomic_load_n(&self->writer, __ATOMIC_SEQ_CST))) return index;
+
+        // back off so the writer can drain the slot
+        if (__atomic_sub_fetch(&slot->readers, 1, __ATOMIC_SEQ_CST) == 0) Futex_Wake(&slot->readers, 1);
+        RwLock__WaitWriter(self);
+    }
+}
+
+static inline void RwLock_ReadUnlock(RwLock* self, u32 slot_index)
+{
+    RwLock__Slot* slot = &self->slots[slot_index];
+
+    // the writer only sleeps on a slot after announcing itself, tell it once the slot is empty
+    if (__atomic_sub_fetch(&slot->readers, 1, __ATOMIC_SEQ_CST) == 0 && unlikely(__atomic_load_n(&self->writer, __ATOMIC_SEQ_CST))) {
+        Futex_Wake(&slot->readers, 1);
+    }
+}
+
+SYM_WEAK
+void RwLock_WriteLock(RwLock* self)
+{
+    u32 free = 0;
+    if (!__atomic_compare_exchange_n(&self->writer, &free, 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+        // same as a contended Mutex, sleepers may remain so the lock is held as contended from here
+        while (__atomic_exchange_n(&self->writer, 2, __ATOMIC_SEQ_CST)) {
+            Futex_Wait(&self->writer, 2, NULL);
+        }
+    }
+
+    // new readers back off now, wait for the ones already inside
+    for (usize ii = 0; ii <= self->mask; ii++) {
+        u32* readers = &self->slots[ii].readers;
+
+        u32 count = __atomic_load_n(readers, __ATOMIC_SEQ_CST);
+        for (usize jj = 0; count && jj < MUTEX_SPIN; jj++) {
+            CPU_RELAX();
+            count = __atomic_load_n(readers, __ATOMIC_SEQ_CST);
+        }
+
+        while (count) {
+            Futex_Wait(readers, count, NULL);
+            count = __atomic_load_n(readers, __ATOMIC_SEQ_CST);
+        }
+    }
+}
+
+SYM_WEAK
+void RwLock_WriteUnlock(RwLock* self)
+{
+    // readers and writers sleep on the same word, all readers can go at once anyway
+    if (__atomic_exchange_n(&self->writer, 0, __ATOMIC_RELEASE) == 2) Futex_Wake(&self->writer, INT32_MAX);
+}
+
+static inline u32 SeqLock_ReadBegin(const SeqLock* self)
+{
+    u32 seq;
+    while ((seq = __atomic_load_n(&self->seq, __ATOMIC_ACQUIRE)) & 1) {
+        CPU_RELAX();
+    }
+
+    return seq;
+}
+
+static inline bool SeqLock_ReadRetry(const SeqLock* self, u32 seq)
+{
+    // keeps the data reads from moving past the second look at the sequence
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&self->seq, __ATOMIC_RELAXED) != seq;
+}
+
+static inline void SeqLock_WriteBegin(SeqLock* self)
+{
+    for (;;) {
+        u32 seq = __atomic_load_n(&self->seq, __ATOMIC_RELAXED);
+        if (!(seq & 1) && __atomic_compare_exchange_n(&self->seq, &seq, seq + 1, true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) break;
+
+        CPU_RELAX();
+    }
+
+    // keeps the data writes from moving before the sequence turns odd
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void SeqLock_WriteEnd(SeqLock* self)
+{
+    __atomic_store_n(&self->seq, __atomic_load_n(&self->seq, __ATOMIC_RELAXED) + 1, __ATOMIC_RELEASE);
+}
+
+SYM_WEAK
+void SeqLock_Read(const SeqLock* self, void* restrict dst, const void* src, usize size)
+{
+    u32 seq;
+    do {
+        seq = SeqLock_ReadBegin(self);
+
+        // copied with atomic loads, the data races with the writer until the retry check passes
+        if (!(((uptr)dst | (uptr)src | size) & 7)) {
+            for (usize ii = 0; ii < size / 8; ii++) {
+                ((u64*)dst)[ii] = __atomic_load_n(&((const u64*)src)[ii], __ATOMIC_RELAXED);
+            }
+        } else {
+            for (usize ii = 0; ii < size; ii++) {
+                ((u8*)dst)[ii] = __atomic_load_n(&((const u8*)src)[ii], __ATOMIC_RELAXED);
+            }
+        }
+    } while (SeqLock_ReadRetry(self, seq));
+}
+
+SYM_WEAK
+void SeqLock_Write(SeqLock* self, void* dst, const void* restrict src, usize size)
+{
+    SeqLock_WriteBegin(self);
+
+    if (!(((uptr)dst | (uptr)src | size) & 7)) {
+        for (usize ii = 0; ii < size / 8; ii++) {
+            __atomic_store_n(&((u64*)dst)[ii], ((const u64*)src)[ii], __ATOMIC_RELAXED);
+        }
+    } else {
+        for (usize ii = 0; ii < size; ii++) {
+            __atomic_store_n(&((u8*)dst)[ii], ((const u8*)src)[ii], __ATOMIC_RELAXED);
+        }
+    }
+
+    SeqLock_WriteEnd(self);
+}
+
+/* --- Thread Pool --- */
+
+#define TASK_GROUP__SLEEPING (U32_C(1) << 31)
+
+typedef struct ThreadPoolWorker {
+    StealDeque(ThreadPoolTask) tasks;
+    ThreadPool*                pool;
+    pthread_t                  thread;
+    u64                        rng;
+} ATTR(aligned(TARGET_CACHE_LINE_SIZE)) ThreadPoolWorker;
+
+typedef struct {
+    void (*fn)(void* ctx, usize lo, usize hi);
+    void* ctx;
+    usize grain;
+} ThreadPool__Loop;
+
+SYM_WEAK _Thread_local ThreadPoolWorker* ThreadPool__worker;
+
+// the calling thread's worker if it belongs to `self`
+static inline ThreadPoolWorker* ThreadPool__Worker(ThreadPool* self)
+{
+    ThreadPoolWorker* worker = ThreadPool__worker;
+    return worker && worker->pool == self ? worker : NULL;
+}
+
+static inline void ThreadPool__Signal(ThreadPool* self)
+{
+    // pairs with the fence in the sleeping counter's increment, either they see the task or we see them
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (!__atomic_load_n(&self->sleeping, __ATOMIC_RELAXED)) return;
+
+    __atomic_add_fetch(&self->signal, 1, __ATOMIC_RELEASE);
+    Futex_Wake(&self->signal, 1);
+}
+
+SYM_WEAK
+bool ThreadPool__Take(ThreadPool* self, ThreadPoolWorker* worker, ThreadPoolTask* task)
+{
+    if (worker && StealDeque_Pop(ThreadPoolTask)(&worker->tasks, task)) return true;
+    if (MpmcQueue_TryPop(ThreadPoolTask)(&self->inject, task)) return true;
+
+    usize count = self->num_workers;
+    if (!count) return false;
+
+    usize start = 0;
+    if (worker) {
+        worker->rng ^= worker->rng << 13;
+        worker->rng ^= worker->rng >> 7;
+        worker->rng ^= worker->rng << 17;
+        start        = worker->rng % count;
+    }
+
+    for (usize ii = 0; ii < count; ii++) {
+        ThreadPoolWorker* victim = &self->workers[(start + ii) % count];
+        if (victim != worker && StealDeque_Steal(ThreadPoolTask)(&victim->tasks, task)) return true;
+    }
+
+    return false;
+}
+
+static inline void ThreadPool__Done(TaskGroup* group)
+{
+    // the waiter may return as soon as the count drops, the wake is the last access to the group
+    if (__atomic_sub_fetch(&group->state, 1, __ATOMIC_ACQ_REL) == TASK_GROUP__SLEEPING) {
+        Futex_Wake(&group->state, INT32_MAX);
+    }
+}
+
+static inline void ThreadPool__Run(ThreadPool* self, ThreadPoolWorker* worker, const ThreadPoolTask* task);
+
+// queues the task, runs it right away if the queue is full
+static inline void ThreadPool__Push(ThreadPool* self, ThreadPoolWorker* worker, const ThreadPoolTask* task)
+{
+    __atomic_add_fetch(&task->group->state, 1, __ATOMIC_RELAXED);
+
+    bool queued = worker ? StealDeque_Push(ThreadPoolTask)(&worker->tasks, task)
+                         : MpmcQueue_TryPush(ThreadPoolTask)(&self->inject, task);
+
+    if (!queued) {
+        ThreadPool__Run(self, worker, task);
+        return;
+    }
+
+    ThreadPool__Signal(self);
+}
+
+// true while the thread's queue is empty, i.e. nobody could steal work from it
+static inline bool ThreadPool__Starving(ThreadPool* self, ThreadPoolWorker* worker)
+{
+    return worker ? !StealDeque_Length(ThreadPoolTask)(&worker->tasks) : !MpmcQueue_Length(ThreadPoolTask)(&self->inject);
+}
+
+// lazy binary splitting: runs the range a grain at a time, handing its back half to the pool whenever the pool is
+// out of work, so a range is only split as often as there are idle threads to take the pieces
+SYM_WEAK
+void ThreadPool__RunRange(ThreadPool* self, ThreadPoolWorker* worker, const ThreadPoolTask* task)
+{
+    ThreadPool__Loop* loop  = task->arg;
+    usize             begin = task->begin;
+    usize             end   = task->end;
+
+    while (begin < end) {
+        while (end - begin > loop->grain && ThreadPool__Starving(self, worker)) {
+            usize mid = begin + (end - begin) / 2;
+
+            ThreadPoolTask half = {.fn = NULL, .arg = loop, .begin = mid, .end = end, .group = task->group};
+            ThreadPool__Push(self, worker, &half);
+
+            end = mid;
+        }
+
+        usize stop = begin + min(loop->grain, end - begin);
+        loop->fn(loop->ctx, begin, stop);
+        begin = stop;
+    }
+}
+
+static inline void ThreadPool__Run(ThreadPool* self, ThreadPoolWorker* worker, const ThreadPoolTask* task)
+{
+    if (task->fn) {
+        task->fn(task->arg);
+    } else {
+        ThreadPool__RunRange(self, worker, task);
+    }
+
+    ThreadPool__Done(task->group);
+}
+
+SYM_WEAK
+void* ThreadPool__WorkerMain(void* arg)
+{
+    ThreadPoolWorker* worker = arg;
+    ThreadPool*       self   = worker->pool;
+
+    ThreadPool__worker = worker;
+
+    usize idle = 0;
+    for (;;) {
+        ThreadPoolTask task;
+        if (ThreadPool__Take(self, worker, &task)) {
+            ThreadPool__Run(self, worker, &task);
+            idle = 0;
+            continue;
+        }
+
+        if (__atomic_load_n(&self->stopping, __ATOMIC_ACQUIRE)) break;
+
+        if (idle++ < THREAD_POOL_SPIN) {
+            CPU_RELAX();
+            continue;
+        }
+
+        // announce we're going to sleep, then look once more so a concurrent spawn can't be missed
+        u32 signal = __atomic_load_n(&self->signal, __ATOMIC_ACQUIRE);
+        __atomic_add_fetch(&self->sleeping, 1, __ATOMIC_SEQ_CST);
+
+        bool found = ThreadPool__Take(self, worker, &task);
+        if (!found && !__atomic_load_n(&self->stopping, __ATOMIC_ACQUIRE)) Futex_Wait(&self->signal, signal, NULL);
+
+        __atomic_sub_fetch(&self->sleeping, 1, __ATOMIC_SEQ_CST);
+        idle = 0;
+
+        if (found) ThreadPool__Run(self, worker, &task);
+    }
+
+    ThreadPool__worker = NULL;
+    return NULL;
+}
+
+SYM_WEAK
+bool ThreadPool_New(ThreadPool* self, usize num_threads)
+{
+    if (!num_threads) num_threads = max(sysconf(_SC_NPROCESSORS_ONLN), 1) - 1;
+
+    memset(self, 0x00, sizeof(*self));
+    if (!MpmcQueue_New(ThreadPoolTask)(&self->inject, THREAD_POOL_INJECT_SIZE)) return false;
+
+    if (!num_threads) return true;
+
+    usize             size    = alignp2_64(num_threads * sizeof(ThreadPoolWorker), TARGET_CACHE_LINE_SIZE);
+    ThreadPoolWorker* workers = ALIGNED_MALLOC(TARGET_CACHE_LINE_SIZE, size);
+    if (!workers) {
+        MpmcQueue_Delete(ThreadPoolTask)(&self->inject);
+        return false;
+    }
+
+    memset(workers, 0x00, size);
+
+    for (usize ii = 0; ii < num_threads; ii++) {
+        if (!StealDeque_New(ThreadPoolTask)(&workers[ii].tasks, THREAD_POOL_QUEUE_SIZE)) {
+            while (ii--) StealDeque_Delete(ThreadPoolTask)(&workers[ii].tasks);
+            ALIGNED_FREE(workers);
+            MpmcQueue_Delete(ThreadPoolTask)(&self->inject);
+            return false;
+        }
+
+        workers[ii].pool = self;
+        workers[ii].rng  = (ii + 1) * U64_C(0x9E3779B97F4A7C15);
+    }
+
+    self->workers = workers;
+
+    for (usize ii = 0; ii < num_threads; ii++) {
+        if (pthread_create(&workers[ii].thread, NULL, ThreadPool__WorkerMain, &workers[ii])) {
+            // the started workers see an empty pool and exit with the stop
+            for (usize jj = ii; jj < num_threads; jj++) StealDeque_Delete(ThreadPoolTask)(&workers[jj].tasks);
+            self->num_workers = ii;
+            ThreadPool_Delete(self);
+            return false;
+        }
+
+        self->num_workers = ii + 1;
+    }
+
+    return true;
+}
+
+SYM_WEAK
+void ThreadPool_Delete(ThreadPool* self)
+{
+    __atomic_store_n(&self->stopping, 1, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&self->signal, 1, __ATOMIC_RELEASE);
+    Futex_Wake(&self->signal, INT32_MAX);
+
+    for (usize ii = 0; ii < self->num_workers; ii++) {
+        pthread_join(self->workers[ii].thread, NULL);
+    }
+
+    for (usize ii = 0; ii < self->num_workers; ii++) {
+        StealDeque_Delete(ThreadPoolTask)(&self->workers[ii].tasks);
+    }
+
+    ALIGNED_FREE(self->workers);
+    MpmcQueue_Delete(ThreadPoolTask)(&self->inject);
+
+    self->workers     = NULL;
+    self->num_workers = 0;
+}
+
+SYM_WEAK
+void ThreadPool_Spawn(ThreadPool* self, TaskGroup* group, void (*fn)(void* arg), void* arg)
+{
+    ThreadPoolTask task = {.fn = fn, .arg = arg, .group = group};
+    ThreadPool__Push(self, ThreadPool__Worker(self), &task);
+}
+
+SYM_WEAK
+void ThreadPool_Wait(ThreadPool* self, TaskGroup* group)
+{
+    ThreadPoolWorker* worker = ThreadPool__Worker(self);
+
+    usize idle = 0;
+    for (;;) {
+        u32 state = __atomic_load_n(&group->state, __ATOMIC_ACQUIRE);
+        if (!(state & ~TASK_GROUP__SLEEPING)) break;
+
+        // help out, with any task and not just the group's, it's all work the group may be waiting behind
+        ThreadPoolTask task;
+        if (ThreadPool__Take(self, worker, &task)) {
+            ThreadPool__Run(self, worker, &task);
+            idle = 0;
+            continue;
+        }
+
+        if (idle++ < THREAD_POOL_SPIN) {
+            CPU_RELAX();
+            continue;
+        }
+
+        // the remaining tasks are running elsewhere, sleep until the last one finishes
+        if (!(state & TASK_GROUP__SLEEPING)) {
+            if (!__atomic_compare_exchange_n(&group->state, &state, state | TASK_GROUP__SLEEPING, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                continue;
+            }
+        }
+
+        Futex_Wait(&group->state, state | TASK_GROUP__SLEEPING, NULL);
+    }
+
+    __atomic_store_n(&group->state, 0, __ATOMIC_RELAXED);
+}
+
+SYM_WEAK
+void ThreadPool_ParallelFor(ThreadPool* self, usize begin, usize end, usize grain, void (*fn)(void* ctx, usize lo, usize hi), void* ctx)
+{
+    if (begin >= end) return;
+
+    // a few pieces per thread, enough to even out uneven iterations without splitting down to single elements
+    if (!grain) grain = max((end - begin) / (8 * (self->num_workers + 1)), (usize)1);
+
+    ThreadPool__Loop loop  = {.fn = fn, .ctx = ctx, .grain = grain};
+    TaskGroup        group = TASK_GROUP_INIT;
+
+    // the caller runs the whole range as one task, splitting it as idle workers show up
+    ThreadPoolTask task = {.fn = NULL, .arg = &loop, .begin = begin, .end = end, .group = &group};
+    __atomic_add_fetch(&group.state, 1, __ATOMIC_RELAXED);
+
+    ThreadPoolWorker* worker = ThreadPool__Worker(self);
+    ThreadPool__Run(self, worker, &task);
+    ThreadPool_Wait(self, &group);
+}
@@ -0,0 +1,569 @@
+#pragma once
+
+#include <string.h>
+
+#include <deggua/target.h>
+
+#if TARGET_ARCH == TARGET_ARCH_AMD64
+#    include <immintrin.h>
+#endif
+
+#include <deggua/types.h>
+#include <deggua/bitops.h>
+#include <deggua/string.h>
+
+// UTF-8 validation, codepoint counting and conversion to/from UTF-16 and UTF-32. Validation follows the lookup table
+// approach (Keiser, Lemire: "Validating UTF-8 In Less Than One Instruction Per Byte"): three 16 entry tables indexed
+// by the nibbles of each byte and the one before it flag every malformed pair, 3 and 4 byte sequences are checked by
+// looking two and three bytes back, so a block costs a handful of shuffles no matter what it contains. Overlongs,
+// surrogates and codepoints past U+10FFFF are all rejected.
+
+#define UTF8_INVALID (USIZE_MAX) // returned by the conversions for malformed input
+
+bool  Utf8_Validate(const void* data, usize len);
+bool  Utf8_ValidateString(const String* str);
+usize Utf8_CountCodepoints(const void* data, usize len); // Codepoints in valid UTF-8 (the bytes that aren't continuation bytes)
+usize Utf8_Utf16Length(const void* data, usize len);     // UTF-16 units needed for valid UTF-8
+
+// `dst` must have room for the worst case: `len` units from UTF-8, 3 bytes per unit from UTF-16, 4 per codepoint from
+// UTF-32. Each returns the units written or UTF8_INVALID, `dst` holds garbage after a failure.
+usize Utf8_ToUtf16(const void* src, usize len, u16* dst);
+usize Utf8_ToUtf32(const void* src, usize len, u32* dst);
+usize Utf16_ToUtf8(const u16* src, usize len, u8* dst); // Unpaired surrogates are invalid
+usize Utf32_ToUtf8(const u32* src, usize len, u8* dst); // Surrogates and codepoints past U+10FFFF are invalid
+
+/* --- Implementation --- */
+
+/* --- Validation --- */
+
+// decodes the sequence at `src`, returns its length or 0 if it's malformed or cut short
+static inline usize Utf8__Decode(const u8* src, usize len, u32* codepoint)
+{
+    u8 lead = src[0];
+
+    if (lead < 0x80) {
+        *codepoint = lead;
+        return 1;
+    }
+
+    if (lead < 0xC2) return 0; // continuation byte or overlong 2 byte lead
+
+    if (lead < 0xE0) {
+        if (len < 2 || (src[1] & 0xC0) != 0x80) return 0;
+
+        *codepoint = ((u32)(lead & 0x1F) << 6) | (src[1] & 0x3F);
+        return 2;
+    }
+
+    if (lead < 0xF0) {
+        if (len < 3 || (src[1] & 0xC0) != 0x80 || (src[2] & 0xC0) != 0x80) return 0;
+
+        u32 cp = ((u32)(lead & 0x0F) << 12) | ((u32)(src[1] & 0x3F) << 6) | (src[2] & 0x3F);
+        if (cp < 0x800 || (cp >= 0xD800 && cp <= 0xDFFF)) return 0;
+
+        *codepoint = cp;
+        return 3;
+    }
+
+    if (lead < 0xF5) {
+        if (len < 4 || (src[1] & 0xC0) != 0x80 || (src[2] & 0xC0) != 0x80 || (src[3] & 0xC0) != 0x80) return 0;
+
+        u32 cp = ((u32)(lead & 0x07) << 18) | ((u32)(src[1] & 0x3F) << 12) | ((u32)(src[2] & 0x3F) << 6) | (src[3] & 0x3F);
+        if (cp < 0x10000 || cp > 0x10FFFF) return 0;
+
+        *codepoint = cp;
+        return 4;
+    }
+
+    return 0;
+}
+
+// number of leading ASCII bytes, checked 8 at a time
+static inline usize Utf8__AsciiPrefix(const u8* src, usize len)
+{
+    usize ii = 0;
+    for (; ii + 8 <= len; ii += 8) {
+        u64 word;
+        memcpy(&word, src + ii, sizeof(word));
+        if (word & U64_C(0x8080808080808080)) break;
+    }
+
+    while (ii < len && src[ii] < 0x80) ii++;
+
+    return ii;
+}
+
+SYM_WEAK
+bool Utf8__ValidateScalar(const u8* src, usize len)
+{
+    usize ii = 0;
+    while (ii < len) {
+        ii += Utf8__AsciiPrefix(src + ii, len - ii);
+        if (ii == len) break;
+
+        u32   codepoint;
+        usize step = Utf8__Decode(src + ii, len - ii, &codepoint);
+        if (!step) return false;
+
+        ii += step;
+    }
+
+    return true;
+}
+
+#if TARGET_ARCH == TARGET_ARCH_AMD64
+
+// error classes, a pair of bytes is malformed when a class is set in all three lookups
+#define UTF8__TOO_SHORT      (1 << 0) // lead byte followed by a lead or ASCII
+#define UTF8__TOO_LONG       (1 << 1) // ASCII followed by a continuation
+#define UTF8__OVERLONG_3     (1 << 2)
+#define UTF8__TOO_LARGE      (1 << 3)
+#define UTF8__SURROGATE      (1 << 4)
+#define UTF8__OVERLONG_2     (1 << 5)
+#define UTF8__TOO_LARGE_1000 (1 << 6)
+#define UTF8__OVERLONG_4     (1 << 6)
+#define UTF8__TWO_CONTS      (1 << 7) // two continuations in a row, fine if the third/fourth byte check expects one
+#define UTF8__CARRY          (UTF8__TOO_SHORT | UTF8__TOO_LONG | UTF8__TWO_CONTS)
+
+// indexed by the high nibble of the previous byte
+#define UTF8__BYTE_1_HIGH                                                                           \
+    UTF8__TOO_LONG, UTF8__TOO_LONG, UTF8__TOO_LONG, UTF8__TOO_LONG,                                 \
+    UTF8__TOO_LONG, UTF8__TOO_LONG, UTF8__TOO_LONG, UTF8__TOO_LONG,                                 \
+    UTF8__TWO_CONTS, UTF8__TWO_CONTS, UTF8__TWO_CONTS, UTF8__TWO_CONTS,                             \
+    UTF8__TOO_SHORT | UTF8__OVERLONG_2,                                                             \
+    UTF8__TOO_SHORT,                                                                                \
+    UTF8__TOO_SHORT | UTF8__OVERLONG_3 | UTF8__SURROGATE,                                           \
+    UTF8__TOO_SHORT | UTF8__TOO_LARGE | UTF8__TOO_LARGE_1000 | UTF8__OVERLONG_4
+
+// indexed by the low nibble of the previous byte
+#define UTF8__BYTE_1_LOW                                                                            \
+    UTF8__CARRY | UTF8__OVERLONG_3 | UTF8__OVERLONG_2 | UTF8__OVERLONG_4,                           \
+    UTF8__CARRY | UTF8__OVERLONG_2,                                                                 \
+    UTF8__CARRY,                                                                                    \
+    UTF8__CARRY,                                                                                    \
+    UTF8__CARRY | UTF8__TOO_LARGE,                                                                  \
+    UTF8__CARRY | UTF8__TOO_LARGE | UTF8__TOO_LARGE_1000,                                           \
+    UTF8__CARRY | UTF8__TOO_LARGE | UTF8__TOO_LARGE_1000,                                           \
+    UTF8__CARRY | UTF8__TOO_LARGE | UTF8__TOO_LARGE_1000,                                           \
+    UTF8__CARRY | UTF8__TOO_LARGE | UTF8__TOO_LARGE_1000,                                           \
+    UTF8__CARRY | UTF8__TOO_LARGE | UTF8__TOO_LARGE_1000,                                           \
+    UTF8__CARRY | UTF8__TOO_LARGE | UTF8__TOO_LARGE_1000,                                           \
+    UTF8__CARRY | UTF8__TOO_LARGE | UTF8__TOO_LARGE_1000,                                           \
+    UTF8__CARRY | UTF8__TOO_LARGE | UTF8__TOO_LARGE_1000,                                           \
+    UTF8__CARRY | UTF8__TOO_LARGE | UTF8__TOO_LARGE_1000 | UTF8__SURROGATE,                         \
+    UTF8__CARRY | UTF8__TOO_LARGE | UTF8__TOO_LARGE_1000,                                           \
+    UTF8__CARRY | UTF8__TOO_LARGE | UTF8__TOO_LARGE_1000
+
+// indexed by the high nibble of the current byte
+#define UTF8__BYTE_2_HIGH                                                                           \
+    UTF8__TOO_SHORT, UTF8__TOO_SHORT, UTF8__TOO_SHORT, UTF8__TOO_SHORT,                             \
+    UTF8__TOO_SHORT, UTF8__TOO_SHORT, UTF8__TOO_SHORT, UTF8__TOO_SHORT,                             \
+    UTF8__TOO_LONG | UTF8__OVERLONG_2 | UTF8__TWO_CONTS | UTF8__OVERLONG_3 | UTF8__TOO_LARGE_1000 | UTF8__OVERLONG_4, \
+    UTF8__TOO_LONG | UTF8__OVERLONG_2 | UTF8__TWO_CONTS | UTF8__OVERLONG_3 | UTF8__TOO_LARGE,       \
+    UTF8__TOO_LONG | UTF8__OVERLONG_2 | UTF8__TWO_CONTS | UTF8__SURROGATE | UTF8__TOO_LARGE,        \
+    UTF8__TOO_LONG | UTF8__OVERLONG_2 | UTF8__TWO_CONTS | UTF8__SURROGATE | UTF8__TOO_LARGE,        \
+    UTF8__TOO_SHORT, UTF8__TOO_SHORT, UTF8__TOO_SHORT, UTF8__TOO_SHORT
+
+SYM_WEAK ATTR(target("ssse3"))
+bool Utf8__ValidateSsse3(const u8* src, usize len)
+{
+    const __m128i byte_1_high = _mm_setr_epi8(UTF8__BYTE_1_HIGH);
+    const __m128i byte_1_low  = _mm_setr_epi8(UTF8__BYTE_1_LOW);
+    const __m128i byte_2_high = _mm_setr_epi8(UTF8__BYTE_2_HIGH);
+    const __m128i nibble      = _mm_set1_epi8(0x0F);
+    // anything above these at the end of a block starts a sequence that continues into the next one
+    const __m128i incomplete  = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1);
+
+    __m128i prev       = _mm_setzero_si128();
+    __m128i prev_short = _mm_setzero_si128();
+    __m128i error      = _mm_setzero_si128();
+
+    u8    tail[16];
+    usize ii = 0;
+
+    while (ii < len) {
+        __m128i input;
+        if (likely(ii + 16 <= len)) {
+            input = _mm_loadu_si128((const __m128i*)(src + ii));
+        } else {
+            // zero padding is ASCII, a sequence cut short by the end of the input fails like one cut short by ASCII
+            memset(tail, 0x00, sizeof(tail));
+            memcpy(tail, src + ii, len - ii);
+            input = _mm_loadu_si128((const __m128i*)tail);
+        }
+
+        ii += 16;
+
+        if (!_mm_movemask_epi8(input)) {
+            // all ASCII, only a sequence left open by the previous block can be wrong
+            error      = _mm_or_si128(error, prev_short);
+            prev       = input;
+            prev_short = _mm_setzero_si128();
+            continue;
+        }
+
+        __m128i prev1 = _mm_alignr_epi8(input, prev, 15);
+        __m128i prev2 = _mm_alignr_epi8(input, prev, 14);
+        __m128i prev3 = _mm_alignr_epi8(input, prev, 13);
+
+        __m128i special = _mm_and_si128(
+            _mm_and_si128(
+                _mm_shuffle_epi8(byte_1_high, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+                _mm_shuffle_epi8(byte_1_low, _mm_and_si128(prev1, nibble))),
+            _mm_shuffle_epi8(byte_2_high, _mm_and_si128(_mm_srli_epi16(input, 4), nibble)));
+
+        // third and fourth bytes of 3/4 byte sequences must be continuations, which is the TWO_CONTS bit (0x80)
+        __m128i must_23 = _mm_or_si128(_mm_subs_epu8(prev2, _mm_set1_epi8(0xE0 - 0x80)), _mm_subs_epu8(prev3, _mm_set1_epi8(0xF0 - 0x80)));
+        __m128i must_80 = _mm_and_si128(must_23, _mm_set1_epi8(0x80));
+
+        error      = _mm_or_si128(error, _mm_xor_si128(must_80, special));
+        prev       = input;
+        prev_short = _mm_subs_epu8(input, incomplete);
+    }
+
+    error = _mm_or_si128(error, prev_short);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xFFFF;
+}
+
+SYM_WEAK ATTR(target("avx2"))
+bool Utf8__ValidateAvx2(const u8* src, usize len)
+{
+    const __m256i byte_1_high = _mm256_setr_epi8(UTF8__BYTE_1_HIGH, UTF8__BYTE_1_HIGH);
+    const __m256i byte_1_low  = _mm256_setr_epi8(UTF8__BYTE_1_LOW, UTF8__BYTE_1_LOW);
+    const __m256i byte_2_high = _mm256_setr_epi8(UTF8__BYTE_2_HIGH, UTF8__BYTE_2_HIGH);
+    const __m256i nibble      = _mm256_set1_epi8(0x0F);
+    const __m256i incomplete  = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1);
+
+    __m256i prev       = _mm256_setzero_si256();
+    __m256i prev_short = _mm256_setzero_si256();
+    __m256i error      = _mm256_setzero_si256();
+
+    u8    tail[32];
+    usize ii = 0;
+
+    while (ii < len) {
+        __m256i input;
+        if (likely(ii + 32 <= len)) {
+            input = _mm256_loadu_si256((const __m256i*)(src + ii));
+        } else {
+            memset(tail, 0x00, sizeof(tail));
+            memcpy(tail, src + ii, len - ii);
+            input = _mm256_loadu_si256((const __m256i*)tail);
+        }
+
+        ii += 32;
+
+        if (!_mm256_movemask_epi8(input)) {
+            error      = _mm256_or_si256(error, prev_short);
+            prev       = input;
+            prev_short = _mm256_setzero_si256();
+            continue;
+        }
+
+        // byte shifts don't cross the 128 bit lanes, the previous block's high lane is spliced in for the low one
+        __m256i carry = _mm256_permute2x128_si256(prev, input, 0x21);
+        __m256i prev1 = _mm256_alignr_epi8(input, carry, 15);
+        __m256i prev2 = _mm256_alignr_epi8(input, carry, 14);
+        __m256i prev3 = _mm256_alignr_epi8(input, carry, 13);
+
+        __m256i special = _mm256_and_si256(
+            _mm256_and_si256(
+                _mm256_shuffle_epi8(byte_1_high, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+                _mm256_shuffle_epi8(byte_1_low, _mm256_and_si256(prev1, nibble))),
+            _mm256_shuffle_epi8(byte_2_high, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble)));
+
+        __m256i must_23 = _mm256_or_si256(_mm256_subs_epu8(prev2, _mm256_set1_epi8(0xE0 - 0x80)), _mm256_subs_epu8(prev3, _mm256_set1_epi8(0xF0 - 0x80)));
+        __m256i must_80 = _mm256_and_si256(must_23, _mm256_set1_epi8(0x80));
+
+        error      = _mm256_or_si256(error, _mm256_xor_si256(must_80, special));
+        prev       = input;
+        prev_short = _mm256_subs_epu8(input, incomplete);
+    }
+
+    error = _mm256_or_si256(error, prev_short);
+    return _mm256_testz_si256(error, error);
+}
+
+#endif
+
+SYM_WEAK
+bool Utf8_Validate(const void* data, usize len)
+{
+    const u8* src = data;
+
+#if TARGET_ARCH == TARGET_ARCH_AMD64
+    // short strings are done before the vector setup would pay off
+    if (len >= 32) {
+        i32 level = String__SimdLevel();
+        if (level >= STRING__SIMD_AVX2) return Utf8__ValidateAvx2(src, len);
+        if (level >= STRING__SIMD_SSSE3) return Utf8__ValidateSsse3(src, len);
+    }
+#endif
+
+    return Utf8__ValidateScalar(src, len);
+}
+
+SYM_WEAK
+bool Utf8_ValidateString(const String* str)
+{
+    return Utf8_Validate(str->at, str->len);
+}
+
+/* --- Counting --- */
+
+// bytes that start a codepoint, everything but continuation bytes (which are below -64 as i8)
+static inline usize Utf8__CountLeadsScalar(const u8* src, usize len)
+{
+    usize count = 0;
+    for (usize ii = 0; ii < len; ii++) {
+        count += (i8)src[ii] > -65;
+    }
+
+    return count;
+}
+
+#if TARGET_ARCH == TARGET_ARCH_AMD64
+
+SYM_WEAK
+usize Utf8__CountLeadsSse2(const u8* src, usize len)
+{
+    const __m128i threshold = _mm_set1_epi8(-65);
+
+    usize count = 0;
+    usize ii    = 0;
+    for (; ii + 16 <= len; ii += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(src + ii));
+        count        += popcnt_32(_mm_movemask_epi8(_mm_cmpgt_epi8(block, threshold)));
+    }
+
+    return count + Utf8__CountLeadsScalar(src + ii, len - ii);
+}
+
+SYM_WEAK ATTR(target("avx2"))
+usize Utf8__CountLeadsAvx2(const u8* src, usize len)
+{
+    const __m256i threshold = _mm256_set1_epi8(-65);
+
+    usize count = 0;
+    usize ii    = 0;
+    for (; ii + 32 <= len; ii += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(src + ii));
+        count        += popcnt_32(_mm256_movemask_epi8(_mm256_cmpgt_epi8(block, threshold)));
+    }
+
+    return count + Utf8__CountLeadsSse2(src + ii, len - ii);
+}
+
+#endif
+
+static inline usize Utf8__CountLeads(const u8* src, usize len)
+{
+#if TARGET_ARCH == TARGET_ARCH_AMD64
+    if (String__SimdLevel() >= STRING__SIMD_AVX2) return Utf8__CountLeadsAvx2(src, len);
+    return Utf8__CountLeadsSse2(src, len);
+#else
+    return Utf8__CountLeadsScalar(src, len);
+#endif
+}
+
+SYM_WEAK
+usize Utf8_CountCodepoints(const void* data, usize len)
+{
+    return Utf8__CountLeads(data, len);
+}
+
+SYM_WEAK
+usize Utf8_Utf16Length(const void* data, usize len)
+{
+    const u8* src = data;
+
+    // every codepoint is one unit, the ones from 4 byte sequences need a surrogate pair (one more)
+    usize four = 0;
+    for (usize ii = 0; ii < len; ii++) {
+        four += src[ii] >= 0xF0;
+    }
+
+    return Utf8__CountLeads(src, len) + four;
+}
+
+/* --- Conversion --- */
+
+// widens the leading ASCII bytes to 16 bits, returns how many were converted
+static inline usize Utf8__AsciiToUtf16(const u8* src, usize len, u16* dst)
+{
+    usize ii = 0;
+
+#if TARGET_ARCH == TARGET_ARCH_AMD64
+    for (; ii + 16 <= len; ii += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(src + ii));
+        if (_mm_movemask_epi8(block)) break;
+
+        _mm_storeu_si128((__m128i*)(dst + ii), _mm_unpacklo_epi8(block, _mm_setzero_si128()));
+        _mm_storeu_si128((__m128i*)(dst + ii + 8), _mm_unpackhi_epi8(block, _mm_setzero_si128()));
+    }
+#endif
+
+    for (; ii < len && src[ii] < 0x80; ii++) {
+        dst[ii] = src[ii];
+    }
+
+    return ii;
+}
+
+static inline usize Utf8__AsciiToUtf32(const u8* src, usize len, u32* dst)
+{
+    usize ii = 0;
+
+#if TARGET_ARCH == TARGET_ARCH_AMD64
+    for (; ii + 16 <= len; ii += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(src + ii));
+        if (_mm_movemask_epi8(block)) break;
+
+        __m128i lo = _mm_unpacklo_epi8(block, _mm_setzero_si128());
+        __m128i hi = _mm_unpackhi_epi8(block, _mm_setzero_si128());
+
+        _mm_storeu_si128((__m128i*)(dst + ii), _mm_unpacklo_epi16(lo, _mm_setzero_si128()));
+        _mm_storeu_si128((__m128i*)(dst + ii + 4), _mm_unpackhi_epi16(lo, _mm_setzero_si128()));
+        _mm_storeu_si128((__m128i*)(dst + ii + 8), _mm_unpacklo_epi16(hi, _mm_setzero_si128()));
+        _mm_storeu_si128((__m128i*)(dst + ii + 12), _mm_unpackhi_epi16(hi, _mm_setzero_si128()));
+    }
+#endif
+
+    for (; ii < len && src[ii] < 0x80; ii++) {
+        dst[ii] = src[ii];
+    }
+
+    return ii;
+}
+
+SYM_WEAK
+usize Utf8_ToUtf16(const void* data, usize len, u16* dst)
+{
+    const u8* src   = data;
+    u16*      start = dst;
+
+    usize ii = 0;
+    while (ii < len) {
+        usize ascii = Utf8__AsciiToUtf16(src + ii, len - ii, dst);
+        ii  += ascii;
+        dst += ascii;
+        if (ii == len) break;
+
+        u32   codepoint;
+        usize step = Utf8__Decode(src + ii, len - ii, &codepoint);
+        if (!step) return UTF8_INVALID;
+
+        if (codepoint < 0x10000) {
+            *dst++ = codepoint;
+        } else {
+            codepoint -= 0x10000;
+            *dst++     = 0xD800 | (codepoint >> 10);
+            *dst++     = 0xDC00 | (codepoint & 0x3FF);
+        }
+
+        ii += step;
+    }
+
+    return dst - start;
+}
+
+SYM_WEAK
+usize Utf8_ToUtf32(const void* data, usize len, u32* dst)
+{
+    const u8* src   = data;
+    u32*      start = dst;
+
+    usize ii = 0;
+    while (ii < len) {
+        usize ascii = Utf8__AsciiToUtf32(src + ii, len - ii, dst);
+        ii  += ascii;
+        dst += ascii;
+        if (ii == len) break;
+
+        usize step = Utf8__Decode(src + ii, len - ii, dst);
+        if (!step) return UTF8_INVALID;
+
+        ii  += step;
+        dst += 1;
+    }
+
+    return dst - start;
+}
+
+// encodes a valid codepoint, returns the bytes written
+static inline usize Utf8__Encode(u32 codepoint, u8* dst)
+{
+    if (codepoint < 0x80) {
+        dst[0] = codepoint;
+        return 1;
+    }
+
+    if (codepoint < 0x800) {
+        dst[0] = 0xC0 | (codepoint >> 6);
+        dst[1] = 0x80 | (codepoint & 0x3F);
+        return 2;
+    }
+
+    if (codepoint < 0x10000) {
+        dst[0] = 0xE0 | (codepoint >> 12);
+        dst[1] = 0x80 | ((codepoint >> 6) & 0x3F);
+        dst[2] = 0x80 | (codepoint & 0x3F);
+        return 3;
+    }
+
+    dst[0] = 0xF0 | (codepoint >> 18);
+    dst[1] = 0x80 | ((codepoint >> 12) & 0x3F);
+    dst[2] = 0x80 | ((codepoint >> 6) & 0x3F);
+    dst[3] = 0x80 | (codepoint & 0x3F);
+    return 4;
+}
+
+SYM_WEAK
+usize Utf16_ToUtf8(const u16* src, usize len, u8* dst)
+{
+    u8* start = dst;
+
+    usize ii = 0;
+    while (ii < len) {
+#if TARGET_ARCH == TARGET_ARCH_AMD64
+        // narrow runs of ASCII 8 units at a time
+        while (ii + 8 <= len) {
+            __m128i block = _mm_loadu_si128((const __m128i*)(src + ii));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(block, _mm_set1_epi16((short)0xFF80)), _mm_setzero_si128())) != 0xFFFF) break;
+
+            _mm_storel_epi64((__m128i*)dst, _mm_packus_epi16(block, block));
+            ii  += 8;
+            dst += 8;
+        }
+        if (ii == len) break;
+#endif
+
+        u32 codepoint = src[ii++];
+        if (codepoint >= 0xD800 && codepoint <= 0xDFFF) {
+            // a high surrogate followed by a low one
+            if (codepoint > 0xDBFF || ii == len || src[ii] < 0xDC00 || src[ii] > 0xDFFF) return UTF8_INVALID;
+            codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (src[ii++] - 0xDC00);
+        }
+
+        dst += Utf8__Encode(codepoint, dst);
+    }
+
+    return dst - start;
+}
+
+SYM_WEAK
+usize Utf32_ToUtf8(const u32* src, usize len, u8* dst)
+{
+    u8* start = dst;
+
+    for (usize ii = 0; ii < len; ii++) {
+        u32 codepoint = src[ii];
+        if (codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF)) return UTF8_INVALID;
+
+        dst += Utf8__Encode(codepoint, dst);
+    }
+
+    return dst - start;
+}